@@ -0,0 +1,118 @@
+/*
+ * Arduino.h
+ * Minimal stand-in for the Arduino core so the library sources build into host tools
+ *
+ * Only what the library itself uses is provided. Timing comes from the host's steady clock,
+ * pins do nothing, and Serial output goes to stderr so it never mixes with a tool's stdout.
+ *
+ * Copyright (c) 2016 Damien Clarke
+ * Licensed under the MIT License (MIT), see LICENSE
+ */
+
+#ifndef RAR_HOST_ARDUINO_H
+#define RAR_HOST_ARDUINO_H
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+
+using std::abs;
+
+typedef uint8_t byte;
+
+#define F(string) (string)
+#define PROGMEM
+#define pgm_read_word(addr) (*(const unsigned short*)(addr))
+#define pgm_read_byte(addr) (*(const unsigned char*)(addr))
+
+#define INPUT 0
+#define LOW 0
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+inline unsigned long micros()
+{
+  static const std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+  return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - origin).count();
+}
+inline unsigned long millis() { return micros() / 1000; }
+inline void delay(unsigned long ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+
+// interrupts are one lock: a tool that simulates an interrupt handler holds it while the handler runs,
+// so noInterrupts() in the library keeps handlers out exactly like on the board
+inline std::mutex& rarHostInterruptLock()
+{
+  static std::mutex lock;
+  return lock;
+}
+// a handler left here runs once, the next time the library enables interrupts, like a pending interrupt does on
+// the board. Lets a single threaded check land a handler exactly between two critical sections
+inline void (*&rarHostPendingInterrupt())()
+{
+  static void (*handler)() = NULL;
+  return handler;
+}
+inline void noInterrupts() { rarHostInterruptLock().lock(); }
+inline void interrupts()
+{
+  void (*pending)() = rarHostPendingInterrupt();
+  if(pending) {
+    rarHostPendingInterrupt() = NULL;
+    pending();
+  }
+  rarHostInterruptLock().unlock();
+}
+
+inline void pinMode(int, int) {}
+inline void digitalWrite(int, int) {}
+inline int analogRead(int) { return 0; }
+inline void analogReadResolution(int) {}
+inline long map(long x, long inMin, long inMax, long outMin, long outMax)
+{
+  return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+class Print
+{
+  public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) { return fputc(c, stderr) == EOF ? 0 : 1; }
+    virtual size_t write(const uint8_t* buffer, size_t size) { return fwrite(buffer, 1, size, stderr); }
+    virtual int availableForWrite() { return 4096; }
+
+    size_t print(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(long n) { char s[24]; snprintf(s, sizeof(s), "%ld", n); return print(s); }
+    size_t print(int n) { return print((long)n); }
+    size_t print(unsigned long n) { char s[24]; snprintf(s, sizeof(s), "%lu", n); return print(s); }
+    size_t print(unsigned int n) { return print((unsigned long)n); }
+    size_t print(double n) { char s[32]; snprintf(s, sizeof(s), "%.2f", n); return print(s); }
+    size_t println() { return print("\r\n"); }
+    template<typename T> size_t println(T value) { return print(value) + println(); }
+    int printf(const char* format, ...) {
+      va_list args;
+      va_start(args, format);
+      int n = vfprintf(stderr, format, args);
+      va_end(args);
+      return n;
+    }
+};
+
+typedef Print Stream;
+
+inline Print& rarHostSerial()
+{
+  static Print serial;
+  return serial;
+}
+#define Serial rarHostSerial()
+
+#endif
@@ -0,0 +1,308 @@
+/*
+ * rar_bench.cpp
+ * Times ResponsiveAnalogRead::update() on synthetic signals from rar_signal.h
+ *
+ * The input is generated once before timing starts and replayed for every pass, so the numbers are the filter's
+ * alone. Generation is timed separately and reported too. Each workload is timed in several runs, taking turns with
+ * the other workloads so a slow spell on the machine is shared out rather than landing on one of them, and the
+ * filter's output is scored against the noiseless knob position:
+ *   meanAbsError               average distance from the true position, in codes (lag and leftover noise)
+ *   changesPerKSample          value changes per 1000 samples, what downstream code has to handle
+ *   restingChangesPerKSample   value changes per 1000 samples while the knob isn't moving, i.e. jitter let through
+ *
+ * With -j the results are also written as JSON:
+ *   { "benchmark": "rar_bench", "version": 2, "ramBytes": sizeof(ResponsiveAnalogRead) on this host,
+ *     "seed": s, "passes": p, "runs": r,
+ *     "results": [ { "workload": "noisy", "samples": n, "passes": p, "generateNsPerSample": x,
+ *                    "nsPerSample": [one per run], "samplesPerSecond": [...], "cyclesPerSample": [...],
+ *                    "meanAbsError": x, "changesPerKSample": x, "restingChangesPerKSample": x }, ... ] }
+ * cyclesPerSample counts time stamp counter ticks and is only present on x86. Flash size depends on the board's
+ * compiler and has to come from the board build. Runs within one process share its luck with the machine, so to
+ * compare builds run each of them several times, alternating, and give rar_bench_compare all the files.
+ *
+ * Build: g++ -O2 -std=c++11 -pthread -I. -I../../src -o rar_bench rar_bench.cpp ../../src/Responsive*.cpp
+ * Usage: rar_bench [-w workload] [-n samples] [-p passes] [-r runs] [-s seed] [-j results.json]
+ *        workloads: quiet, noisy, hum, pwm, sag, 12bit, all (default all)
+ *
+ * Copyright (c) 2016 Damien Clarke
+ * Licensed under the MIT License (MIT), see LICENSE
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <vector>
+#include "ResponsiveAnalogRead.h"
+#include "rar_signal.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define RAR_BENCH_CYCLES 1
+#endif
+
+struct Workload
+{
+  const char* name;
+  RarSignalConfig config;
+};
+
+struct Result
+{
+  const char* workload;
+  size_t samples;
+  int passes;
+  double generateNsPerSample;
+  std::vector<double> nsPerSample;
+  std::vector<double> samplesPerSecond;
+  std::vector<double> cyclesPerSample;
+  double meanAbsError;
+  double changesPerKSample;
+  double restingChangesPerKSample;
+};
+
+static std::vector<Workload> workloads()
+{
+  std::vector<Workload> list;
+  Workload w;
+
+  w.name = "quiet";
+  w.config = RarSignalConfig();
+  w.config.whiteNoise = 0.5;
+  list.push_back(w);
+
+  w.name = "noisy";
+  w.config = RarSignalConfig();
+  w.config.whiteNoise = 2.0;
+  w.config.pinkNoise = 1.0;
+  list.push_back(w);
+
+  w.name = "hum";
+  w.config = RarSignalConfig();
+  w.config.hum = 3.0;
+  list.push_back(w);
+
+  w.name = "pwm";
+  w.config = RarSignalConfig();
+  w.config.pwmAmplitude = 12.0;
+  list.push_back(w);
+
+  w.name = "sag";
+  w.config = RarSignalConfig();
+  w.config.sagDepth = 0.05;
+  w.config.brownNoise = 0.05;
+  list.push_back(w);
+
+  w.name = "12bit";
+  w.config = RarSignalConfig();
+  w.config.bits = 12;
+  w.config.whiteNoise = 4.0;
+  w.config.inl = 2.0;
+  list.push_back(w);
+
+  return list;
+}
+
+static void usage()
+{
+  fprintf(stderr, "usage: rar_bench [-w quiet|noisy|hum|pwm|sag|12bit|all] [-n samples] [-p passes] [-r runs] [-s seed] [-j results.json]\n");
+  exit(2);
+}
+
+static double secondsSince(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static inline uint64_t cycles()
+{
+#ifdef RAR_BENCH_CYCLES
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+// the timed loop's results are stored here so the compiler can't drop the loop
+static volatile unsigned long long benchSink;
+
+static ResponsiveAnalogRead makeFilter(int maxCode)
+{
+  ResponsiveAnalogRead analog;
+  analog.begin(0, true);
+  analog.setAnalogResolution(maxCode + 1);
+  return analog;
+}
+
+// a workload's input, generated once and replayed for every timed run
+struct Prepared
+{
+  Result result;
+  std::vector<int> input;
+  int maxCode;
+};
+
+static void prepare(const Workload& workload, size_t samples, int passes, uint64_t seed, Prepared& prepared)
+{
+  Result& result = prepared.result;
+  result.workload = workload.name;
+  result.samples = samples;
+  result.passes = passes;
+
+  std::vector<int>& input = prepared.input;
+  input.resize(samples);
+  std::vector<float> truth(samples);
+  RarSignal signal(workload.config, seed);
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  signal.fill(input.data(), truth.data(), input.size());
+  result.generateNsPerSample = secondsSince(start) * 1e9 / samples;
+  prepared.maxCode = signal.getMaxCode();
+
+  // quality, once: the same seed always gives the same answer
+  ResponsiveAnalogRead analog = makeFilter(prepared.maxCode);
+  double error = 0.0;
+  unsigned long long changes = 0, restingChanges = 0, resting = 0;
+  for(size_t i = 0; i < input.size(); i++) {
+    analog.update(input[i]);
+    error += fabs(analog.getValue() - truth[i]);
+    changes += analog.hasChanged();
+    if(i > 0 && truth[i] == truth[i - 1]) {
+      resting++;
+      restingChanges += analog.hasChanged();
+    }
+  }
+  result.meanAbsError = error / samples;
+  result.changesPerKSample = changes * 1000.0 / samples;
+  result.restingChangesPerKSample = resting ? restingChanges * 1000.0 / resting : 0.0;
+}
+
+// one timed run on a fresh filter, so every run does the same work
+static void timeRun(Prepared& prepared)
+{
+  Result& result = prepared.result;
+  const std::vector<int>& input = prepared.input;
+  ResponsiveAnalogRead timed = makeFilter(prepared.maxCode);
+  unsigned long long sink = 0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  uint64_t startCycles = cycles();
+  for(int pass = 0; pass < result.passes; pass++) {
+    for(size_t i = 0; i < input.size(); i++) {
+      timed.update(input[i]);
+      sink += timed.hasChanged();
+    }
+  }
+  uint64_t elapsedCycles = cycles() - startCycles;
+  double seconds = secondsSince(start);
+  double filtered = (double)result.samples * result.passes;
+  benchSink = sink;
+
+  result.nsPerSample.push_back(seconds * 1e9 / filtered);
+  result.samplesPerSecond.push_back(filtered / seconds);
+#ifdef RAR_BENCH_CYCLES
+  result.cyclesPerSample.push_back(elapsedCycles / filtered);
+#else
+  (void)elapsedCycles;
+#endif
+}
+
+static void writeArray(FILE* out, const char* name, const std::vector<double>& values)
+{
+  fprintf(out, "      \"%s\": [", name);
+  for(size_t i = 0; i < values.size(); i++) {
+    fprintf(out, "%s%.6g", i ? ", " : "", values[i]);
+  }
+  fprintf(out, "],\n");
+}
+
+static bool writeJson(const char* path, const std::vector<Result>& results, uint64_t seed, int passes, int runs)
+{
+  FILE* out = fopen(path, "w");
+  if(!out) {
+    return false;
+  }
+  fprintf(out, "{\n  \"benchmark\": \"rar_bench\",\n  \"version\": 2,\n  \"ramBytes\": %zu,\n", sizeof(ResponsiveAnalogRead));
+  fprintf(out, "  \"seed\": %llu,\n  \"passes\": %d,\n  \"runs\": %d,\n  \"results\": [\n", (unsigned long long)seed, passes, runs);
+  for(size_t i = 0; i < results.size(); i++) {
+    const Result& r = results[i];
+    fprintf(out, "    {\n      \"workload\": \"%s\",\n      \"samples\": %zu,\n      \"passes\": %d,\n", r.workload, r.samples, r.passes);
+    fprintf(out, "      \"generateNsPerSample\": %.6g,\n", r.generateNsPerSample);
+    writeArray(out, "nsPerSample", r.nsPerSample);
+    writeArray(out, "samplesPerSecond", r.samplesPerSecond);
+    if(!r.cyclesPerSample.empty()) {
+      writeArray(out, "cyclesPerSample", r.cyclesPerSample);
+    }
+    fprintf(out, "      \"meanAbsError\": %.6g,\n      \"changesPerKSample\": %.6g,\n      \"restingChangesPerKSample\": %.6g\n    }%s\n",
+      r.meanAbsError, r.changesPerKSample, r.restingChangesPerKSample, i + 1 < results.size() ? "," : "");
+  }
+  fprintf(out, "  ]\n}\n");
+  return fclose(out) == 0;
+}
+
+static double mean(const std::vector<double>& values)
+{
+  double sum = 0.0;
+  for(size_t i = 0; i < values.size(); i++) {
+    sum += values[i];
+  }
+  return values.empty() ? 0.0 : sum / values.size();
+}
+
+int main(int argc, char** argv)
+{
+  const char* workloadName = "all";
+  const char* jsonPath = NULL;
+  size_t samples = 1 << 20;
+  int passes = 10;
+  int runs = 10;
+  uint64_t seed = 1;
+  for(int i = 1; i + 1 < argc; i += 2) {
+    const char* value = argv[i + 1];
+    if(strcmp(argv[i], "-w") == 0) workloadName = value;
+    else if(strcmp(argv[i], "-n") == 0) samples = strtoul(value, NULL, 10);
+    else if(strcmp(argv[i], "-p") == 0) passes = atoi(value);
+    else if(strcmp(argv[i], "-r") == 0) runs = atoi(value);
+    else if(strcmp(argv[i], "-s") == 0) seed = strtoull(value, NULL, 10);
+    else if(strcmp(argv[i], "-j") == 0) jsonPath = value;
+    else usage();
+  }
+  if(argc % 2 == 0 || samples == 0 || passes <= 0 || runs <= 0) {
+    usage();
+  }
+
+  std::vector<Workload> list = workloads();
+  std::vector<Prepared> prepared;
+  for(size_t i = 0; i < list.size(); i++) {
+    if(strcmp(workloadName, "all") == 0 || strcmp(list[i].name, workloadName) == 0) {
+      prepared.push_back(Prepared());
+      prepare(list[i], samples, passes, seed, prepared.back());
+    }
+  }
+  if(prepared.empty()) {
+    usage();
+  }
+  for(int r = 0; r < runs; r++) {
+    for(size_t i = 0; i < prepared.size(); i++) {
+      timeRun(prepared[i]);
+    }
+  }
+  std::vector<Result> results;
+  for(size_t i = 0; i < prepared.size(); i++) {
+    results.push_back(prepared[i].result);
+  }
+
+  printf("%zu samples x %d passes, %d runs, ResponsiveAnalogRead is %zu bytes\n", samples, passes, runs, sizeof(ResponsiveAnalogRead));
+  printf("%-8s %10s %10s %10s %10s %10s %10s\n", "workload", "gen ns", "ns/sample", "Msample/s", "error", "chg/k", "rest chg/k");
+  for(size_t i = 0; i < results.size(); i++) {
+    const Result& r = results[i];
+    printf("%-8s %10.2f %10.2f %10.2f %10.3f %10.2f %10.3f\n", r.workload, r.generateNsPerSample, mean(r.nsPerSample),
+      mean(r.samplesPerSecond) / 1e6, r.meanAbsError, r.changesPerKSample, r.restingChangesPerKSample);
+  }
+
+  if(jsonPath && !writeJson(jsonPath, results, seed, passes, runs)) {
+    perror(jsonPath);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,373 @@
+/*
+ * rar_bench_compare.cpp
+ * Compares rar_bench JSON results and flags significant regressions
+ *
+ * Runs inside one rar_bench process are not independent: they share its memory layout, clock speed and neighbours,
+ * and the whole process can come out several percent slower or faster than the next one. So each result file counts
+ * as one sample, the median of its runs, and timing is only tested when both sides have at least two files: a workload
+ * regressed when the 95% confidence interval of the slowdown (Welch's t-test over the files' medians) lies entirely
+ * above zero and its midpoint is beyond the threshold. With one file per side the change is shown but not judged.
+ * Only nsPerSample is tested, cyclesPerSample is the same timing in other units. Quality metrics and RAM are
+ * deterministic for a given seed and are compared directly. Files made with a different seed or number of passes
+ * replay different input and are refused.
+ *
+ * Build: g++ -O2 -std=c++11 -o rar_bench_compare rar_bench_compare.cpp
+ * Usage: rar_bench_compare [-t thresholdPercent] [-q qualityTolerancePercent] baseline.json current.json
+ *        rar_bench_compare [-t thresholdPercent] [-q qualityTolerancePercent] baseline.json... -- current.json...
+ *        exits with 1 when anything regressed, so it can gate a build. Run the two builds alternately, e.g.
+ *          for i in 1 2 3; do ./rar_bench_old -j old$i.json; ./rar_bench_new -j new$i.json; done
+ *          rar_bench_compare old*.json -- new*.json
+ *
+ * Copyright (c) 2016 Damien Clarke
+ * Licensed under the MIT License (MIT), see LICENSE
+ */
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+// just enough JSON for rar_bench's output: objects, arrays, numbers and strings without escapes
+struct JsonValue
+{
+  enum Type { NONE, NUMBER, STRING, ARRAY, OBJECT } type = NONE;
+  double number = 0.0;
+  std::string string;
+  std::vector<JsonValue> items;
+  std::vector<std::pair<std::string, JsonValue> > members;
+
+  const JsonValue* get(const char* name) const {
+    for(size_t i = 0; i < members.size(); i++) {
+      if(members[i].first == name) {
+        return &members[i].second;
+      }
+    }
+    return NULL;
+  }
+};
+
+class JsonParser
+{
+  public:
+    explicit JsonParser(const std::string& text) : text(text), at(0) {}
+
+    bool parse(JsonValue& value) {
+      return parseValue(value) && (skipSpace(), at == text.size());
+    }
+
+  private:
+    const std::string& text;
+    size_t at;
+
+    void skipSpace() {
+      while(at < text.size() && isspace((unsigned char)text[at])) at++;
+    }
+
+    bool expect(char c) {
+      skipSpace();
+      if(at < text.size() && text[at] == c) {
+        at++;
+        return true;
+      }
+      return false;
+    }
+
+    bool parseString(std::string& out) {
+      if(!expect('"')) return false;
+      size_t end = text.find('"', at);
+      if(end == std::string::npos) return false;
+      out = text.substr(at, end - at);
+      at = end + 1;
+      return true;
+    }
+
+    bool parseValue(JsonValue& value) {
+      skipSpace();
+      if(at >= text.size()) return false;
+      char c = text[at];
+      if(c == '{') {
+        at++;
+        value.type = JsonValue::OBJECT;
+        if(expect('}')) return true;
+        do {
+          std::pair<std::string, JsonValue> member;
+          if(!parseString(member.first) || !expect(':') || !parseValue(member.second)) return false;
+          value.members.push_back(member);
+        } while(expect(','));
+        return expect('}');
+      }
+      if(c == '[') {
+        at++;
+        value.type = JsonValue::ARRAY;
+        if(expect(']')) return true;
+        do {
+          value.items.push_back(JsonValue());
+          if(!parseValue(value.items.back())) return false;
+        } while(expect(','));
+        return expect(']');
+      }
+      if(c == '"') {
+        value.type = JsonValue::STRING;
+        return parseString(value.string);
+      }
+      char* end;
+      value.number = strtod(text.c_str() + at, &end);
+      if(end == text.c_str() + at) return false;
+      value.type = JsonValue::NUMBER;
+      at = end - text.c_str();
+      return true;
+    }
+};
+
+static bool load(const char* path, JsonValue& root)
+{
+  FILE* in = fopen(path, "rb");
+  if(!in) {
+    perror(path);
+    return false;
+  }
+  std::string text;
+  char block[4096];
+  size_t n;
+  while((n = fread(block, 1, sizeof(block), in)) > 0) {
+    text.append(block, n);
+  }
+  fclose(in);
+
+  JsonParser parser(text);
+  if(!parser.parse(root) || root.type != JsonValue::OBJECT || !root.get("results")) {
+    fprintf(stderr, "%s: not a rar_bench result file\n", path);
+    return false;
+  }
+  return true;
+}
+
+static std::vector<double> numbers(const JsonValue* array)
+{
+  std::vector<double> values;
+  if(array) {
+    for(size_t i = 0; i < array->items.size(); i++) {
+      values.push_back(array->items[i].number);
+    }
+  }
+  return values;
+}
+
+static double number(const JsonValue* object, const char* name)
+{
+  const JsonValue* value = object->get(name);
+  return value ? value->number : 0.0;
+}
+
+static void meanVariance(const std::vector<double>& values, double& mean, double& variance)
+{
+  mean = 0.0;
+  for(size_t i = 0; i < values.size(); i++) mean += values[i];
+  mean /= values.size();
+  variance = 0.0;
+  for(size_t i = 0; i < values.size(); i++) variance += (values[i] - mean) * (values[i] - mean);
+  variance = values.size() > 1 ? variance / (values.size() - 1) : 0.0;
+}
+
+static double median(std::vector<double> values)
+{
+  std::sort(values.begin(), values.end());
+  size_t n = values.size();
+  return n % 2 ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2.0;
+}
+
+// two sided 95% quantile of Student's t: exact for the few degrees of freedom a handful of files gives, rounding down
+// to the larger quantile, then the normal quantile with the Cornish-Fisher correction (within 0.1% from 11 on)
+static double tQuantile95(double df)
+{
+  static const double exact[] = { 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228 };
+  if(df < 11.0) {
+    return exact[df < 1.0 ? 0 : (int)df - 1];
+  }
+  const double z = 1.959964;
+  double z3 = z * z * z, z5 = z3 * z * z;
+  return z + (z3 + z) / (4.0 * df) + (5.0 * z5 + 16.0 * z3 + 3.0 * z) / (96.0 * df * df);
+}
+
+struct Options
+{
+  double threshold = 2.0; // percent
+  double qualityTolerance = 1.0; // percent
+};
+
+// base and current hold one median per result file, returns true if the timing regressed
+static bool compareTiming(const char* workload, const std::vector<double>& base, const std::vector<double>& current,
+  const Options& options)
+{
+  if(base.empty() || current.empty()) {
+    return false;
+  }
+  double baseMean, baseVariance, currentMean, currentVariance;
+  meanVariance(base, baseMean, baseVariance);
+  meanVariance(current, currentMean, currentVariance);
+
+  double change = (currentMean - baseMean) / baseMean * 100.0;
+  if(base.size() < 2 || current.size() < 2) {
+    printf("%-8s %-20s %10.3f -> %10.3f  %+7.2f%%  (not tested, needs two or more results per side)\n", workload,
+      "nsPerSample", baseMean, currentMean, change);
+    return false;
+  }
+
+  // Welch: the two sets of files may have different spreads
+  double baseError = baseVariance / base.size();
+  double currentError = currentVariance / current.size();
+  double standardError = sqrt(baseError + currentError);
+  double df = standardError > 0.0 ? pow(baseError + currentError, 2) /
+    (baseError * baseError / (base.size() - 1) + currentError * currentError / (current.size() - 1)) : 1e9;
+  double margin = tQuantile95(df) * standardError / baseMean * 100.0;
+
+  const char* verdict = "";
+  bool regressed = false;
+  if(change - margin > 0.0 && change > options.threshold) {
+    verdict = "REGRESSION";
+    regressed = true;
+  } else if(change + margin < 0.0 && -change > options.threshold) {
+    verdict = "improved";
+  }
+  printf("%-8s %-20s %10.3f -> %10.3f  %+7.2f%% +-%5.2f%%  %s\n", workload, "nsPerSample", baseMean, currentMean,
+    change, margin, verdict);
+  return regressed;
+}
+
+// quality metrics are all lower-is-better and deterministic
+static bool compareQuality(const char* workload, const char* metric, double base, double current, const Options& options)
+{
+  bool regressed = current > base * (1.0 + options.qualityTolerance / 100.0) + 1e-9;
+  if(regressed || fabs(current - base) > 1e-9) {
+    double change = base != 0.0 ? (current - base) / base * 100.0 : 0.0;
+    printf("%-8s %-20s %10.3f -> %10.3f  %+7.2f%%  %s\n", workload, metric, base, current, change, regressed ? "REGRESSION" : "");
+  }
+  return regressed;
+}
+
+static void usage()
+{
+  fprintf(stderr, "usage: rar_bench_compare [-t thresholdPercent] [-q qualityTolerancePercent] baseline.json current.json\n"
+    "       rar_bench_compare [-t thresholdPercent] [-q qualityTolerancePercent] baseline.json... -- current.json...\n");
+  exit(2);
+}
+
+// files only compare when they replayed the same input the same number of times
+static bool sameSetup(const char* path, const JsonValue& root, const char* firstPath, const JsonValue& first)
+{
+  const char* fields[] = { "seed", "passes" };
+  for(size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); i++) {
+    const JsonValue* value = root.get(fields[i]);
+    const JsonValue* firstValue = first.get(fields[i]);
+    if(!value || !firstValue) {
+      fprintf(stderr, "%s: no %s recorded, rerun rar_bench to compare it\n", value ? firstPath : path, fields[i]);
+      return false;
+    }
+    if(value->number != firstValue->number) {
+      fprintf(stderr, "%s and %s were made with a different %s, rerun rar_bench with the same -s and -p\n", firstPath,
+        path, fields[i]);
+      return false;
+    }
+  }
+  return true;
+}
+
+static const JsonValue* findWorkload(const JsonValue& root, const std::string& name)
+{
+  const JsonValue* results = root.get("results");
+  for(size_t i = 0; i < results->items.size(); i++) {
+    const JsonValue* workload = results->items[i].get("workload");
+    if(workload && workload->string == name) {
+      return &results->items[i];
+    }
+  }
+  return NULL;
+}
+
+int main(int argc, char** argv)
+{
+  Options options;
+  std::vector<const char*> basePaths, currentPaths;
+  bool separated = false;
+  for(int i = 1; i < argc; i++) {
+    if(strcmp(argv[i], "-t") == 0 && i + 1 < argc) options.threshold = atof(argv[++i]);
+    else if(strcmp(argv[i], "-q") == 0 && i + 1 < argc) options.qualityTolerance = atof(argv[++i]);
+    else if(strcmp(argv[i], "--") == 0 && !separated) separated = true;
+    else if(argv[i][0] == '-') usage();
+    else (separated ? currentPaths : basePaths).push_back(argv[i]);
+  }
+  if(!separated && basePaths.size() == 2) {
+    currentPaths.push_back(basePaths.back());
+    basePaths.pop_back();
+  }
+  if(basePaths.empty() || currentPaths.empty()) {
+    usage();
+  }
+
+  std::vector<JsonValue> baselines(basePaths.size()), currents(currentPaths.size());
+  for(size_t i = 0; i < basePaths.size(); i++) {
+    if(!load(basePaths[i], baselines[i]) || !sameSetup(basePaths[i], baselines[i], basePaths[0], baselines[0])) {
+      return 2;
+    }
+  }
+  for(size_t i = 0; i < currentPaths.size(); i++) {
+    if(!load(currentPaths[i], currents[i]) || !sameSetup(currentPaths[i], currents[i], basePaths[0], baselines[0])) {
+      return 2;
+    }
+  }
+  const JsonValue& baseline = baselines[0];
+  const JsonValue& current = currents[0];
+
+  int regressions = 0;
+  double baseRam = number(&baseline, "ramBytes"), currentRam = number(&current, "ramBytes");
+  if(currentRam > baseRam) {
+    printf("RAM %.0f -> %.0f bytes per ResponsiveAnalogRead  REGRESSION\n", baseRam, currentRam);
+    regressions++;
+  }
+
+  const JsonValue* currentResults = current.get("results");
+  for(size_t i = 0; i < currentResults->items.size(); i++) {
+    const JsonValue& result = currentResults->items[i];
+    const JsonValue* name = result.get("workload");
+    if(!name) {
+      continue;
+    }
+    const char* workload = name->string.c_str();
+    const JsonValue* base = findWorkload(baseline, name->string);
+    if(!base) {
+      printf("%-8s not in the baseline\n", workload);
+      continue;
+    }
+
+    // one median per file that has the workload, at most one timing verdict per workload
+    std::vector<double> baseMedians, currentMedians;
+    for(size_t f = 0; f < baselines.size(); f++) {
+      const JsonValue* found = findWorkload(baselines[f], name->string);
+      std::vector<double> runs = numbers(found ? found->get("nsPerSample") : NULL);
+      if(!runs.empty()) baseMedians.push_back(median(runs));
+    }
+    for(size_t f = 0; f < currents.size(); f++) {
+      const JsonValue* found = findWorkload(currents[f], name->string);
+      std::vector<double> runs = numbers(found ? found->get("nsPerSample") : NULL);
+      if(!runs.empty()) currentMedians.push_back(median(runs));
+    }
+    regressions += compareTiming(workload, baseMedians, currentMedians, options);
+
+    if(number(base, "samples") != number(&result, "samples")) {
+      printf("%-8s different sample counts, quality metrics are not comparable\n", workload);
+      continue;
+    }
+    const char* metrics[] = { "meanAbsError", "changesPerKSample", "restingChangesPerKSample" };
+    for(size_t m = 0; m < sizeof(metrics) / sizeof(metrics[0]); m++) {
+      regressions += compareQuality(workload, metrics[m], number(base, metrics[m]), number(&result, metrics[m]), options);
+    }
+  }
+
+  printf("%d regression%s\n", regressions, regressions == 1 ? "" : "s");
+  return regressions ? 1 : 0;
+}
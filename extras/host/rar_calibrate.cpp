@@ -0,0 +1,288 @@
+/*
+ * rar_calibrate.cpp
+ * Fits reduced multiMap() tables to recorded end-of-line potentiometer sweeps, in parallel across cores
+ *
+ * Each input file is one unit: its channels interleaved (text, or binary int16 with -b), recorded while
+ * every pot is turned slowly and evenly from minimum to maximum. Channels may be swept one after another,
+ * each channel's own sweep is found in the recording. For every unit a calibration blob <unit>.cal is written:
+ *
+ *   "RARC"   magic
+ *   uint8    version (2)
+ *   uint8    channel count
+ *   per channel:
+ *     uint8     point count, 0 when no sweep was found
+ *     uint8     0, padding
+ *     uint16[]  raw inputs, little endian, ascending
+ *     uint8[]   outputs 0-255
+ *     uint8     0, padding when the point count is odd
+ *
+ * the same narrow types ResponsiveMap stores, and every uint16 array starts at an even offset. So once the blob sits
+ * at an even address in flash, e.g. alignas(2) const uint8_t unit[] PROGMEM = { ...xxd -i output... }, each table can
+ * be handed to ResponsiveMap::beginProgmem() as is on little endian cores (AVR, ARM), including ones that fault on
+ * unaligned 16 bit reads like the Cortex-M0.
+ *
+ * Build: g++ -O2 -std=c++11 -pthread -o rar_calibrate rar_calibrate.cpp
+ * Usage: rar_calibrate -c channels [-b] [-p maxPoints] [-e maxError] [-j threads] [-o outDir] unit1.raw unit2.raw ...
+ *        set RAR_TRACE=trace.json to record a timeline of the read, fit and write stages per thread, see rar_trace.h
+ *
+ * Copyright (c) 2016 Damien Clarke
+ * Licensed under the MIT License (MIT), see LICENSE
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include "rar_samples.h"
+#include "rar_trace.h"
+
+struct Options
+{
+  int channels = 0;
+  bool binary = false;
+  int maxPoints = 16; // RESPONSIVE_POOL_MAP_POINTS
+  float maxError = 1.0; // in output steps
+  int threads = 0;
+  int smoothing = 8; // moving average window in samples
+  std::string outDir = ".";
+  std::vector<std::string> files;
+};
+
+struct Point
+{
+  int in;
+  float out;
+};
+
+static void usage()
+{
+  fprintf(stderr, "usage: rar_calibrate -c channels [-b] [-p maxPoints] [-e maxError] [-j threads] [-o outDir] files...\n");
+  exit(2);
+}
+
+static bool parseOptions(int argc, char** argv, Options& options)
+{
+  for(int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    if(arg[0] != '-') {
+      options.files.push_back(arg);
+      continue;
+    }
+    if(strcmp(arg, "-b") == 0) {
+      options.binary = true;
+      continue;
+    }
+    if(i + 1 >= argc) {
+      return false;
+    }
+    const char* value = argv[++i];
+    if(strcmp(arg, "-c") == 0) options.channels = atoi(value);
+    else if(strcmp(arg, "-p") == 0) options.maxPoints = atoi(value);
+    else if(strcmp(arg, "-e") == 0) options.maxError = atof(value);
+    else if(strcmp(arg, "-j") == 0) options.threads = atoi(value);
+    else if(strcmp(arg, "-o") == 0) options.outDir = value;
+    else return false;
+  }
+  return options.channels > 0 && options.channels < 256 && options.maxPoints >= 2 && options.maxPoints < 256
+    && !options.files.empty();
+}
+
+// turn one channel's recording into (raw, position) points along its sweep
+static std::vector<Point> extractSweep(const std::vector<int>& samples, int channels, int channel, int smoothing)
+{
+  size_t frames = samples.size() / channels;
+  std::vector<float> smooth(frames);
+  float sum = 0.0;
+  for(size_t t = 0; t < frames; t++) {
+    sum += samples[t * channels + channel];
+    if(t >= (size_t)smoothing) {
+      sum -= samples[(t - smoothing) * channels + channel];
+    }
+    smooth[t] = sum / std::min<size_t>(t + 1, smoothing);
+  }
+
+  std::vector<Point> points;
+  if(frames < 2) {
+    return points;
+  }
+  float low = *std::min_element(smooth.begin(), smooth.end());
+  float high = *std::max_element(smooth.begin(), smooth.end());
+  float margin = (high - low) * 0.02;
+  if(high - low < 8) {
+    return points;
+  }
+
+  // the sweep runs from the last time the pot sat at its minimum to the first time it reached its maximum
+  size_t end = 0;
+  while(end < frames && smooth[end] < high - margin) end++;
+  size_t start = end;
+  while(start > 0 && smooth[start - 1] > low + margin) start--;
+  if(start > 0) start--;
+  if(end <= start) {
+    return points;
+  }
+
+  // the pot moves evenly, so time along the sweep is the wanted output. Noise may step the reading
+  // backwards, only readings that climb past the highest one so far become points
+  int highest = -1;
+  for(size_t t = start; t <= end; t++) {
+    int raw = (int)(smooth[t] + 0.5);
+    if(raw > highest) {
+      Point p = { raw, 255.0f * (t - start) / (end - start) };
+      points.push_back(p);
+      highest = raw;
+    }
+  }
+  return points;
+}
+
+// greedily add the worst fitting point until the piecewise linear table is within maxError or full
+static std::vector<Point> reduce(const std::vector<Point>& points, int maxPoints, float maxError)
+{
+  std::vector<size_t> keep;
+  keep.push_back(0);
+  keep.push_back(points.size() - 1);
+
+  while((int)keep.size() < maxPoints) {
+    float worst = 0.0;
+    size_t worstIndex = 0;
+    for(size_t k = 0; k + 1 < keep.size(); k++) {
+      const Point& a = points[keep[k]];
+      const Point& b = points[keep[k + 1]];
+      for(size_t i = keep[k] + 1; i < keep[k + 1]; i++) {
+        float fitted = a.out + (b.out - a.out) * (points[i].in - a.in) / (float)(b.in - a.in);
+        float error = fabsf(fitted - points[i].out);
+        if(error > worst) {
+          worst = error;
+          worstIndex = i;
+        }
+      }
+    }
+    if(worst <= maxError) {
+      break;
+    }
+    keep.insert(std::upper_bound(keep.begin(), keep.end(), worstIndex), worstIndex);
+  }
+
+  std::vector<Point> table;
+  for(size_t k = 0; k < keep.size(); k++) {
+    table.push_back(points[keep[k]]);
+  }
+  // the ends always map to the full output range
+  table.front().out = 0.0;
+  table.back().out = 255.0;
+  return table;
+}
+
+static std::string unitName(const std::string& path)
+{
+  size_t slash = path.find_last_of('/');
+  std::string name = slash == std::string::npos ? path : path.substr(slash + 1);
+  size_t dot = name.find_last_of('.');
+  return dot == std::string::npos ? name : name.substr(0, dot);
+}
+
+static bool calibrateUnit(const Options& options, const std::string& path, int& fitted)
+{
+  std::vector<int> samples;
+  {
+    RAR_TRACE_SCOPE("read");
+    FILE* in = fopen(path.c_str(), "rb");
+    if(!in) {
+      perror(path.c_str());
+      return false;
+    }
+    bool ok = rarReadAllSamples(in, options.binary, samples);
+    fclose(in);
+    if(!ok) {
+      fprintf(stderr, "%s: read error\n", path.c_str());
+      return false;
+    }
+  }
+
+  std::vector<uint8_t> blob;
+  {
+    RAR_TRACE_SCOPE("fit");
+    const char magic[] = { 'R', 'A', 'R', 'C', 2 };
+    blob.insert(blob.end(), magic, magic + sizeof(magic));
+    blob.push_back((uint8_t)options.channels);
+
+    for(int c = 0; c < options.channels; c++) {
+      std::vector<Point> sweep = extractSweep(samples, options.channels, c, options.smoothing);
+      if(sweep.size() < 2) {
+        fprintf(stderr, "%s: no sweep found on channel %d\n", path.c_str(), c);
+        blob.push_back(0);
+        blob.push_back(0);
+        continue;
+      }
+      std::vector<Point> table = reduce(sweep, options.maxPoints, options.maxError);
+      blob.push_back((uint8_t)table.size());
+      blob.push_back(0);
+      for(size_t i = 0; i < table.size(); i++) {
+        blob.push_back(table[i].in & 0xFF);
+        blob.push_back(table[i].in >> 8);
+      }
+      for(size_t i = 0; i < table.size(); i++) {
+        blob.push_back((uint8_t)(table[i].out + 0.5));
+      }
+      if(table.size() & 1) {
+        blob.push_back(0);
+      }
+      fitted++;
+    }
+  }
+
+  RAR_TRACE_SCOPE("write");
+  std::string outPath = options.outDir + "/" + unitName(path) + ".cal";
+  FILE* out = fopen(outPath.c_str(), "wb");
+  if(!out || fwrite(blob.data(), 1, blob.size(), out) != blob.size()) {
+    perror(outPath.c_str());
+    if(out) fclose(out);
+    return false;
+  }
+  fclose(out);
+  return true;
+}
+
+int main(int argc, char** argv)
+{
+  Options options;
+  if(!parseOptions(argc, argv, options)) {
+    usage();
+  }
+  if(options.threads <= 0) {
+    options.threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  rarTraceBegin(getenv("RAR_TRACE"));
+
+  // units are handed out one at a time from a shared counter, so slow files don't hold up a whole batch
+  std::atomic<size_t> nextUnit(0);
+  std::atomic<int> failures(0);
+  std::atomic<int> channelsFitted(0);
+  std::vector<std::thread> workers;
+  for(int w = 0; w < options.threads; w++) {
+    workers.push_back(std::thread([&]() {
+      int fitted = 0;
+      size_t unit;
+      while((unit = nextUnit++) < options.files.size()) {
+        if(!calibrateUnit(options, options.files[unit], fitted)) {
+          failures++;
+        }
+      }
+      channelsFitted += fitted;
+    }));
+  }
+  for(size_t w = 0; w < workers.size(); w++) {
+    workers[w].join();
+  }
+
+  fprintf(stderr, "%zu units, %d channels fitted, %d units failed\n", options.files.size(), channelsFitted.load(), failures.load());
+  bool traced = rarTraceEnd();
+  return failures == 0 && traced ? 0 : 1;
+}
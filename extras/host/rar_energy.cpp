@@ -0,0 +1,192 @@
+/*
+ * rar_energy.cpp
+ * Replays a recording under several sampling policies and estimates what each one costs in energy
+ *
+ * Input is one or more interleaved channels (text, or binary int16 with -b) scanned at -f frames per second.
+ * Every policy runs its own ResponsiveAnalogRead per channel with a ResponsiveEnergy attached:
+ *   every     read and filter every channel on every scan
+ *   sleepN    read a sleeping channel only on every Nth scan, e.g. sleep4. Awake channels are read every scan
+ * and a CSV line per policy is written to stdout:
+ *   policy,conversionsPerSecond,filterCyclesPerSecond,skippedFraction,uJPerSecond,meanAbsDeviation,changes
+ * uJPerSecond is the board's average draw in microwatts under the energy model, meanAbsDeviation the average
+ * distance from what "every" outputs on the same scan, i.e. the lag skipping costs while a knob wakes up.
+ *
+ * Build: g++ -O2 -std=c++11 -pthread -I. -I../../src -o rar_energy rar_energy.cpp ../../src/Responsive*.cpp
+ * Usage: rar_energy [-c channels] [-b] [-f scansPerSecond] [-m avr|samd21] [-p every,sleep2,sleep8,...] < recording
+ *
+ * Copyright (c) 2016 Damien Clarke
+ * Licensed under the MIT License (MIT), see LICENSE
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "ResponsiveAnalogRead.h"
+#include "ResponsiveEnergy.h"
+#include "rar_samples.h"
+
+struct Options
+{
+  int channels = 1;
+  bool binary = false;
+  float scansPerSecond = 1000.0;
+  std::string model = "avr";
+  std::string policies = "every,sleep2,sleep4,sleep8,sleep16";
+};
+
+struct Policy
+{
+  std::string name;
+  int sleepDivider; // 1 reads every scan
+  std::vector<ResponsiveAnalogRead> filters;
+  std::vector<ResponsiveEnergyCounters> counters;
+  ResponsiveEnergy energy;
+  double deviation;
+  unsigned long long changes;
+};
+
+static void usage()
+{
+  fprintf(stderr, "usage: rar_energy [-c channels] [-b] [-f scansPerSecond] [-m avr|samd21] [-p every,sleep2,sleep8,...] < recording\n");
+  exit(2);
+}
+
+static bool parseOptions(int argc, char** argv, Options& options)
+{
+  for(int i = 1; i < argc; i++) {
+    if(strcmp(argv[i], "-b") == 0) {
+      options.binary = true;
+      continue;
+    }
+    if(i + 1 >= argc) {
+      return false;
+    }
+    const char* value = argv[++i];
+    if(strcmp(argv[i - 1], "-c") == 0) options.channels = atoi(value);
+    else if(strcmp(argv[i - 1], "-f") == 0) options.scansPerSecond = atof(value);
+    else if(strcmp(argv[i - 1], "-m") == 0) options.model = value;
+    else if(strcmp(argv[i - 1], "-p") == 0) options.policies = value;
+    else return false;
+  }
+  return options.channels > 0 && options.channels < 256 && options.scansPerSecond > 0.0;
+}
+
+static bool parsePolicies(const std::string& list, int channels, std::vector<Policy>& policies)
+{
+  // "every" always runs first, the others are measured against it
+  std::string names = "every," + list;
+  size_t start = 0;
+  while(start < names.size()) {
+    size_t end = names.find(',', start);
+    if(end == std::string::npos) end = names.size();
+    std::string name = names.substr(start, end - start);
+    start = end + 1;
+
+    int divider;
+    if(name == "every") {
+      divider = 1;
+    } else if(name.compare(0, 5, "sleep") == 0 && atoi(name.c_str() + 5) > 0) {
+      divider = atoi(name.c_str() + 5);
+    } else {
+      return false;
+    }
+    if(!policies.empty() && divider == 1) {
+      continue;
+    }
+    policies.push_back(Policy());
+    Policy& policy = policies.back();
+    policy.name = name;
+    policy.sleepDivider = divider;
+    policy.deviation = 0.0;
+    policy.changes = 0;
+  }
+
+  // set up filters and counters once the vector stops moving, the filters keep pointers to the meter
+  for(size_t p = 0; p < policies.size(); p++) {
+    Policy& policy = policies[p];
+    policy.filters.resize(channels);
+    policy.counters.resize(channels);
+    policy.energy.begin(policy.counters.data(), channels);
+    for(int c = 0; c < channels; c++) {
+      policy.filters[c].begin(0, true);
+      policy.filters[c].setEnergy(&policy.energy, c);
+    }
+  }
+  return true;
+}
+
+int main(int argc, char** argv)
+{
+  Options options;
+  if(!parseOptions(argc, argv, options)) {
+    usage();
+  }
+  ResponsiveEnergyModel avr = RESPONSIVE_ENERGY_AVR_16MHZ;
+  ResponsiveEnergyModel samd21 = RESPONSIVE_ENERGY_SAMD21;
+  ResponsiveEnergyModel model;
+  if(options.model == "avr") model = avr;
+  else if(options.model == "samd21") model = samd21;
+  else usage();
+
+  std::vector<Policy> policies;
+  if(!parsePolicies(options.policies, options.channels, policies)) {
+    usage();
+  }
+
+  std::vector<int> samples;
+  if(!rarReadAllSamples(stdin, options.binary, samples)) {
+    perror("read");
+    return 1;
+  }
+  size_t scans = samples.size() / options.channels;
+  if(scans == 0) {
+    fprintf(stderr, "no complete scans in the input\n");
+    return 1;
+  }
+
+  for(size_t scan = 0; scan < scans; scan++) {
+    const int* frame = &samples[scan * options.channels];
+    for(size_t p = 0; p < policies.size(); p++) {
+      Policy& policy = policies[p];
+      for(int c = 0; c < options.channels; c++) {
+        ResponsiveAnalogRead& filter = policy.filters[c];
+        if(filter.isSleeping() && scan % policy.sleepDivider != 0) {
+          policy.energy.skip(c);
+        } else {
+          // the sample stands in for analogRead(), so count its conversion here
+          policy.energy.conversion(c);
+          filter.update(frame[c]);
+          policy.changes += filter.hasChanged();
+        }
+        int distance = filter.getValue() - policies[0].filters[c].getValue();
+        policy.deviation += distance < 0 ? -distance : distance;
+      }
+    }
+  }
+
+  float seconds = scans / options.scansPerSecond;
+  printf("policy,conversionsPerSecond,filterCyclesPerSecond,skippedFraction,uJPerSecond,meanAbsDeviation,changes\n");
+  for(size_t p = 0; p < policies.size(); p++) {
+    Policy& policy = policies[p];
+    double conversions = 0.0, cycles = 0.0, skipped = 0.0, activeUS = 0.0;
+    for(int c = 0; c < options.channels; c++) {
+      const ResponsiveEnergyCounters& counters = policy.energy.getCounters(c);
+      conversions += counters.conversions;
+      cycles += counters.awakeCycles + counters.sleepingCycles;
+      skipped += counters.skipped;
+      activeUS += policy.energy.getActiveUS(c, model);
+    }
+    double visits = (double)scans * options.channels;
+    if(activeUS > seconds * 1e6) {
+      fprintf(stderr, "%s: needs %.0f%% of the CPU under this model, the board can't scan that fast\n", policy.name.c_str(),
+        activeUS / (seconds * 1e4));
+    }
+    printf("%s,%.1f,%.1f,%.4f,%.1f,%.4f,%llu\n", policy.name.c_str(), conversions / seconds, cycles / seconds,
+      skipped / visits, policy.energy.estimateUJPerSecond(model, seconds), policy.deviation / visits, policy.changes);
+  }
+  fprintf(stderr, "%zu scans of %d channels, %.1f s at %g scans/s\n", scans, options.channels, seconds, options.scansPerSecond);
+  return 0;
+}
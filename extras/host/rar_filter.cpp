@@ -0,0 +1,200 @@
+/*
+ * rar_filter.cpp
+ * Streams raw samples from stdin through ResponsiveAnalogRead and writes the responsive values to stdout
+ *
+ * Input is one or more interleaved channels, either whitespace separated text or binary
+ * little endian int16 (-b). Text output is one line per frame with "value changed" pairs per channel,
+ * binary output (-B) is one little endian uint16 per channel and frame with the changed flag in bit 15.
+ *
+ * Build: g++ -O2 -std=c++11 -pthread -I. -I../../src -o rar_filter rar_filter.cpp ../../src/Responsive*.cpp
+ * Usage: rar_filter [-c channels] [-s snapMultiplier] [-t activityThreshold] [-r analogResolution]
+ *                   [-n (sleep off)] [-e (edge snap off)] [-b (binary in)] [-B (binary out)] < raw > filtered
+ *        set RAR_TRACE=trace.json to record a timeline of the read, filter and write stages, see rar_trace.h
+ *
+ * Copyright (c) 2016 Damien Clarke
+ * Licensed under the MIT License (MIT), see LICENSE
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "ResponsiveAnalogRead.h"
+#include "rar_samples.h"
+#include "rar_trace.h"
+
+#define IO_BUFFER (1 << 20)
+
+struct Options
+{
+  int channels = 1;
+  float snapMultiplier = 0.01;
+  float activityThreshold = 4.0;
+  int analogResolution = 1024;
+  bool sleepEnable = true;
+  bool edgeSnapEnable = true;
+  bool binaryIn = false;
+  bool binaryOut = false;
+};
+
+static void usage()
+{
+  fprintf(stderr, "usage: rar_filter [-c channels] [-s snapMultiplier] [-t activityThreshold] [-r analogResolution]\n"
+    "                  [-n] [-e] [-b] [-B]\n"
+    "  -n  disable sleep      -e  disable edge snap\n"
+    "  -b  binary int16 input -B  binary uint16 output, bit 15 = changed\n");
+  exit(2);
+}
+
+static bool parseOptions(int argc, char** argv, Options& options)
+{
+  for(int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    if(arg[0] != '-' || arg[1] == 0 || arg[2] != 0) {
+      return false;
+    }
+    switch(arg[1]) {
+      case 'n': options.sleepEnable = false; continue;
+      case 'e': options.edgeSnapEnable = false; continue;
+      case 'b': options.binaryIn = true; continue;
+      case 'B': options.binaryOut = true; continue;
+    }
+    if(i + 1 >= argc) {
+      return false;
+    }
+    const char* value = argv[++i];
+    switch(arg[1]) {
+      case 'c': options.channels = atoi(value); break;
+      case 's': options.snapMultiplier = atof(value); break;
+      case 't': options.activityThreshold = atof(value); break;
+      case 'r': options.analogResolution = atoi(value); break;
+      default: return false;
+    }
+  }
+  return options.channels > 0 && options.analogResolution > 1;
+}
+
+// buffered stdout, values are formatted by hand because printf dominates at these rates
+class Output
+{
+  public:
+    Output() : buffer(IO_BUFFER), used(0) {}
+    ~Output() { flush(); }
+
+    inline void reserve(size_t bytes) {
+      if(used + bytes > buffer.size()) {
+        flush();
+      }
+    }
+    inline void putByte(uint8_t c) { buffer[used++] = c; }
+    inline void putUnsigned(unsigned value) {
+      char digits[12];
+      int n = 0;
+      do {
+        digits[n++] = '0' + value % 10;
+        value /= 10;
+      } while(value);
+      while(n) {
+        buffer[used++] = digits[--n];
+      }
+    }
+    void flush() {
+      RAR_TRACE_SCOPE("write");
+      if(used && fwrite(buffer.data(), 1, used, stdout) != used) {
+        perror("write");
+        exit(1);
+      }
+      used = 0;
+    }
+
+  private:
+    std::vector<uint8_t> buffer;
+    size_t used;
+};
+
+class Filter
+{
+  public:
+    Filter(const Options& options, Output& out) : options(options), out(out), channels(options.channels), next(0) {
+      for(size_t i = 0; i < channels.size(); i++) {
+        channels[i].begin(0, options.sleepEnable, options.snapMultiplier);
+        channels[i].setActivityThreshold(options.activityThreshold);
+        channels[i].setAnalogResolution(options.analogResolution);
+        if(!options.edgeSnapEnable) {
+          channels[i].disableEdgeSnap();
+        }
+      }
+    }
+
+    inline void operator()(int raw) {
+      ResponsiveAnalogRead& channel = channels[next];
+      channel.update(raw);
+      int value = channel.getValue();
+      bool changed = channel.hasChanged();
+
+      if(options.binaryOut) {
+        out.reserve(2);
+        uint16_t word = (uint16_t)(value & 0x7FFF) | (changed ? 0x8000 : 0);
+        out.putByte(word & 0xFF);
+        out.putByte(word >> 8);
+      } else {
+        out.reserve(16);
+        out.putUnsigned(value < 0 ? 0 : value);
+        out.putByte(' ');
+        out.putByte(changed ? '1' : '0');
+        out.putByte(next + 1 == (int)channels.size() ? '\n' : '\t');
+      }
+
+      if(++next == (int)channels.size()) {
+        next = 0;
+        frames++;
+      }
+    }
+
+    unsigned long long frames = 0;
+
+  private:
+    const Options& options;
+    Output& out;
+    std::vector<ResponsiveAnalogRead> channels;
+    int next;
+};
+
+static void run(Filter& filter, bool binaryIn)
+{
+  RarSampleParser parser(binaryIn);
+  std::vector<uint8_t> block(IO_BUFFER);
+  for(;;) {
+    size_t n;
+    {
+      RAR_TRACE_SCOPE("read");
+      n = fread(block.data(), 1, block.size(), stdin);
+    }
+    if(n == 0) {
+      break;
+    }
+    RAR_TRACE_SCOPE("filter");
+    parser.parse(block.data(), n, filter);
+  }
+  parser.finish(filter);
+}
+
+int main(int argc, char** argv)
+{
+  Options options;
+  if(!parseOptions(argc, argv, options)) {
+    usage();
+  }
+  rarTraceBegin(getenv("RAR_TRACE"));
+
+  {
+    Output out;
+    Filter filter(options, out);
+    run(filter, options.binaryIn);
+    out.flush();
+    fprintf(stderr, "%llu frames of %d channels\n", filter.frames, options.channels);
+  }
+
+  return rarTraceEnd() ? 0 : 1;
+}
@@ -0,0 +1,167 @@
+/*
+ * rar_frame_sim.cpp
+ * Runs ResponsiveFrameEncoder and ResponsiveFrameDecoder over a simulated lossy serial link on Linux
+ *
+ * A ResponsiveAnalogBank is fed a few slowly moving pots and many still, noisy ones. After every update the
+ * encoder's frames go onto the link, which drops and corrupts single bytes during the middle half of the run, and
+ * the receiver decodes whatever has arrived, in uneven chunks as a UART interrupt would hand it over. Checks that
+ *   - the link carries fewer bytes per update than sending every value would (2 per channel),
+ *   - the receiver noticed the damage (lost frames and CRC errors are counted),
+ *   - once the link is clean again the receiver resyncs, and from then on matches the bank after every update,
+ *   - at the end every value on the receiver equals the bank's.
+ * The counts are printed at the end, the exit status is non-zero if any check failed.
+ *
+ * Build: g++ -O2 -std=c++11 -pthread -I. -I../../src -o rar_frame_sim rar_frame_sim.cpp ../../src/Responsive*.cpp
+ * Usage: rar_frame_sim [-c channels] [-m movingChannels] [-u updates] [-d dropOneIn] [-x corruptOneIn] [-s seed]
+ *        -d and -x give the odds per byte while the link is bad, 0 for never
+ *
+ * Copyright (c) 2016 Damien Clarke
+ * Licensed under the MIT License (MIT), see LICENSE
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <random>
+#include <vector>
+#include "ResponsiveFrame.h"
+
+struct Options
+{
+  int channels = 64;
+  int moving = 3;
+  long updates = 200000;
+  int dropOneIn = 3000;
+  int corruptOneIn = 5000;
+  unsigned long seed = 1;
+};
+
+static void usage()
+{
+  fprintf(stderr, "usage: rar_frame_sim [-c channels] [-m movingChannels] [-u updates] [-d dropOneIn] [-x corruptOneIn] [-s seed]\n");
+  exit(2);
+}
+
+static bool parseOptions(int argc, char** argv, Options& options)
+{
+  for(int i = 1; i + 1 < argc; i += 2) {
+    const char* value = argv[i + 1];
+    if(strcmp(argv[i], "-c") == 0) options.channels = atoi(value);
+    else if(strcmp(argv[i], "-m") == 0) options.moving = atoi(value);
+    else if(strcmp(argv[i], "-u") == 0) options.updates = atol(value);
+    else if(strcmp(argv[i], "-d") == 0) options.dropOneIn = atoi(value);
+    else if(strcmp(argv[i], "-x") == 0) options.corruptOneIn = atoi(value);
+    else if(strcmp(argv[i], "-s") == 0) options.seed = strtoul(value, NULL, 10);
+    else return false;
+  }
+  return argc % 2 == 1 && options.channels > 0 && options.channels <= 255 && options.moving >= 0
+    && options.moving <= options.channels && options.updates >= 1000 && options.dropOneIn >= 0 && options.corruptOneIn >= 0;
+}
+
+int main(int argc, char** argv)
+{
+  Options options;
+  if(!parseOptions(argc, argv, options)) {
+    usage();
+  }
+  int count = options.channels;
+  std::mt19937 random(options.seed);
+
+  std::vector<ResponsiveAnalogRead> channels(count);
+  for(int i = 0; i < count; i++) {
+    channels[i].begin(0, true, 0.01);
+  }
+  ResponsiveAnalogBank bank;
+  bank.begin(channels.data(), count);
+  std::vector<uint8_t> pending(RESPONSIVE_FRAME_STORAGE(count));
+  ResponsiveFrameEncoder encoder;
+  encoder.begin(bank, pending.data());
+
+  std::vector<uint16_t> received(count, 0);
+  ResponsiveFrameDecoder decoder;
+  decoder.begin(received.data(), count);
+
+  // the link is bad for the middle half of the run
+  long badFrom = options.updates / 4;
+  long badUntil = options.updates * 3 / 4;
+
+  std::vector<int> positions(count), frame(count);
+  for(int i = 0; i < count; i++) {
+    positions[i] = random() % 1024;
+  }
+  std::vector<uint8_t> link;
+  uint8_t tx[RESPONSIVE_FRAME_MAX_BYTES + 64];
+  unsigned long long bytes = 0, dropped = 0, corrupted = 0;
+  unsigned long long cleanUpdates = 0, mismatchedWhileSynced = 0;
+  long resyncedAt = -1;
+
+  for(long update = 0; update < options.updates; update++) {
+    for(int i = 0; i < count; i++) {
+      if(i < options.moving) {
+        positions[i] = constrain(positions[i] + (int)(random() % 9) - 4, 0, 1023);
+      }
+      frame[i] = constrain(positions[i] + (int)(random() % 3) - 1, 0, 1023);
+    }
+    bank.update(frame.data());
+
+    uint16_t length = encoder.encode(tx, sizeof(tx));
+    bytes += length;
+    bool bad = update >= badFrom && update < badUntil;
+    for(uint16_t i = 0; i < length; i++) {
+      if(bad && options.dropOneIn && random() % options.dropOneIn == 0) {
+        dropped++;
+        continue;
+      }
+      uint8_t byte = tx[i];
+      if(bad && options.corruptOneIn && random() % options.corruptOneIn == 0) {
+        byte ^= 1 << (random() % 8);
+        corrupted++;
+      }
+      link.push_back(byte);
+    }
+
+    // while the link is bad bytes arrive in uneven chunks, afterwards they are decoded every update
+    if(!bad || random() % 4 == 0) {
+      uint16_t used = decoder.decode(link.data(), link.size());
+      link.erase(link.begin(), link.begin() + used);
+    }
+
+    if(update >= badUntil) {
+      cleanUpdates++;
+      if(decoder.isSynced()) {
+        if(resyncedAt < 0) {
+          resyncedAt = update;
+        }
+        for(int i = 0; i < count; i++) {
+          if(received[i] != bank.getValue(i)) {
+            mismatchedWhileSynced++;
+            break;
+          }
+        }
+      }
+    }
+  }
+
+  int mismatched = 0;
+  for(int i = 0; i < count; i++) {
+    mismatched += received[i] != bank.getValue(i);
+  }
+  double bytesPerUpdate = (double)bytes / options.updates;
+  bool damaged = dropped + corrupted > 0;
+  bool noticed = !damaged || decoder.getLost() + decoder.getErrors() > 0;
+
+  printf("%ld updates of %d channels, %.2f bytes per update (%d for every value)\n", options.updates, count,
+    bytesPerUpdate, 2 * count);
+  printf("link: %llu bytes dropped, %llu corrupted; receiver: %u frames lost, %u bad frames\n", dropped, corrupted,
+    decoder.getLost(), decoder.getErrors());
+  if(resyncedAt < 0) {
+    printf("never back in sync after the link cleared, ");
+  } else {
+    printf("in sync %ld updates after the link cleared, ", resyncedAt - badUntil);
+  }
+  printf("%llu of %llu clean updates mismatched while synced, %d channels differ at the end\n", mismatchedWhileSynced,
+    cleanUpdates, mismatched);
+  bool ok = bytesPerUpdate < 2.0 * count && noticed && resyncedAt >= 0 && mismatchedWhileSynced == 0 && mismatched == 0;
+  return ok ? 0 : 1;
+}
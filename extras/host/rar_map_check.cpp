@@ -0,0 +1,225 @@
+/*
+ * rar_map_check.cpp
+ * Checks that every inverse mapping returns the first raw value that maps to an output
+ *
+ * Builds a few fixed tables (a straight 10 bit to byte line, curves with flat runs) and a run of random ones with
+ * non-decreasing outputs, and for every output 0-255 compares the inverse against a brute force scan of the forward
+ * mapping, through
+ *   - a ResponsiveMap in RAM with its inverse table, and one without (binary search),
+ *   - a ResponsiveMap reading the tables with beginProgmem(), and one reading a full lookup table with beginLut(),
+ *   - ResponsiveAnalogRead::inverseMap() on int arrays given to setMap(),
+ *   - ResponsiveAnalogRead::inverseMap() undoing setMinMax(), for rising, falling and widening ranges.
+ * A reachable output that doesn't come back through lookup(inverse(value)) counts as a round trip failure, any
+ * other answer than the first raw value reaching the output as a mismatch. Also checks that a begin call that fails
+ * leaves the map empty, with no inverse table left from the previous tables.
+ * The counts are printed at the end, the exit status is non-zero if any check failed.
+ *
+ * Build: g++ -O2 -std=c++11 -pthread -I. -I../../src -o rar_map_check rar_map_check.cpp ../../src/Responsive*.cpp
+ * Usage: rar_map_check [-t randomTables] [-s seed]
+ *
+ * Copyright (c) 2016 Damien Clarke
+ * Licensed under the MIT License (MIT), see LICENSE
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <functional>
+#include <random>
+#include <vector>
+#include "ResponsiveAnalogRead.h"
+#include "ResponsiveMap.h"
+
+struct Options
+{
+  int tables = 200;
+  unsigned long seed = 1;
+};
+
+struct Counts
+{
+  unsigned long long checked = 0;
+  unsigned long long roundTrip = 0;
+  unsigned long long notFirst = 0;
+};
+
+static const char* pathNames[] = { "inverse table", "binary search", "progmem", "lut", "int arrays", "setMinMax" };
+enum Path { INVERSE_TABLE, SEARCH, PROGMEM_TABLE, LUT, INT_ARRAYS, MIN_MAX, PATHS };
+
+static void usage()
+{
+  fprintf(stderr, "usage: rar_map_check [-t randomTables] [-s seed]\n");
+  exit(2);
+}
+
+static bool parseOptions(int argc, char** argv, Options& options)
+{
+  for(int i = 1; i + 1 < argc; i += 2) {
+    const char* value = argv[i + 1];
+    if(strcmp(argv[i], "-t") == 0) options.tables = atoi(value);
+    else if(strcmp(argv[i], "-s") == 0) options.seed = strtoul(value, NULL, 10);
+    else return false;
+  }
+  return argc % 2 == 1 && options.tables >= 0;
+}
+
+// compares inverse(value) with the first raw value from first towards last whose forward mapping reaches value,
+// for every value from testLow to testHigh. A value past either end of the outputs belongs to that end
+static void checkInverse(Counts& counts, long first, long last, long testLow, long testHigh,
+  const std::function<long(long)>& forward, const std::function<long(long)>& inverse)
+{
+  long step = last >= first ? 1 : -1;
+  bool rising = forward(last) >= forward(first);
+  for(long target = testLow; target <= testHigh; target++) {
+    long expected = last;
+    bool reachable = false;
+    for(long raw = first; raw != last + step; raw += step) {
+      long out = forward(raw);
+      reachable |= out == target;
+      if(rising ? out >= target : out <= target) {
+        expected = raw;
+        break;
+      }
+    }
+    long got = inverse(target);
+    counts.checked++;
+    if(reachable && forward(got) != target) {
+      counts.roundTrip++;
+    }
+    if(got != expected) {
+      counts.notFirst++;
+    }
+  }
+}
+
+static void checkTable(Counts* counts, const std::vector<int>& in, const std::vector<int>& out)
+{
+  uint8_t size = in.size();
+  long first = in[0];
+  long last = in[size - 1];
+
+  std::vector<uint8_t> arena(RESPONSIVE_MAP_INVERSE_BYTES(size));
+  ResponsiveMap withInverse;
+  withInverse.begin(arena.data(), arena.size(), in.data(), out.data(), size);
+  if(!withInverse.hasInverseTable()) {
+    counts[INVERSE_TABLE].notFirst++;
+  }
+  checkInverse(counts[INVERSE_TABLE], first, last, 0, 255,
+    [&](long raw) { return withInverse.lookup(raw); }, [&](long value) { return withInverse.inverse(value); });
+
+  std::vector<uint8_t> smallArena(RESPONSIVE_MAP_BYTES(size));
+  ResponsiveMap search;
+  search.begin(smallArena.data(), smallArena.size(), in.data(), out.data(), size);
+  checkInverse(counts[SEARCH], first, last, 0, 255,
+    [&](long raw) { return search.lookup(raw); }, [&](long value) { return search.inverse(value); });
+
+  std::vector<uint16_t> flashIn(in.begin(), in.end());
+  std::vector<uint8_t> flashOut(out.begin(), out.end());
+  ResponsiveMap progmem;
+  progmem.beginProgmem(flashIn.data(), flashOut.data(), size);
+  checkInverse(counts[PROGMEM_TABLE], first, last, 0, 255,
+    [&](long raw) { return progmem.lookup(raw); }, [&](long value) { return progmem.inverse(value); });
+
+  std::vector<uint8_t> lut(last + 1);
+  for(long raw = 0; raw <= last; raw++) {
+    lut[raw] = search.lookup(raw);
+  }
+  ResponsiveMap lutMap;
+  lutMap.beginLut(lut.data(), lut.size());
+  checkInverse(counts[LUT], 0, last, 0, 255,
+    [&](long raw) { return lutMap.lookup(raw); }, [&](long value) { return lutMap.inverse(value); });
+
+  std::vector<int> intIn(in), intOut(out);
+  ResponsiveAnalogRead analog;
+  analog.setMap(intIn.data(), intOut.data(), size);
+  checkInverse(counts[INT_ARRAYS], first, last, 0, 255,
+    [&](long raw) { return analog.multiMap(raw); }, [&](long value) { return analog.inverseMap(value); });
+}
+
+static void checkMinMax(Counts& counts, int min, int max, int toMin, int toMax)
+{
+  ResponsiveAnalogRead analog;
+  analog.setMinMax(min, max, toMin, toMax);
+  int low = toMin < toMax ? toMin : toMax;
+  int high = toMin < toMax ? toMax : toMin;
+  checkInverse(counts, min, max, low - 5, high + 5,
+    [&](long raw) { return map(raw, min, max, toMin, toMax); }, [&](long value) { return analog.inverseMap(value); });
+}
+
+// begin calls that fail must leave nothing of the previous tables behind
+static unsigned long long checkFailedBegin()
+{
+  const int in[] = { 0, 1023 };
+  const int out[] = { 0, 255 };
+  const int descending[] = { 1023, 0 };
+  const uint16_t flashDescending[] = { 1023, 0 };
+  const uint8_t flashOut[] = { 0, 255 };
+  uint8_t arena[RESPONSIVE_MAP_INVERSE_BYTES(2)];
+  unsigned long long failures = 0;
+
+  for(int attempt = 0; attempt < 4; attempt++) {
+    ResponsiveMap table;
+    table.begin(arena, sizeof(arena), in, out, 2);
+    bool accepted;
+    switch(attempt) {
+      case 0: accepted = table.begin(arena, sizeof(arena), descending, out, 2); break;
+      case 1: accepted = table.begin(arena, RESPONSIVE_MAP_BYTES(2) - 1, in, out, 2); break;
+      case 2: accepted = table.beginProgmem(flashDescending, flashOut, 2); break;
+      default: accepted = table.beginLut(flashOut, 0); break;
+    }
+    if(accepted || table.hasInverseTable() || table.getSize() != 0 || table.lookup(512) != 0 || table.inverse(128) != 0) {
+      failures++;
+    }
+  }
+  return failures;
+}
+
+int main(int argc, char** argv)
+{
+  Options options;
+  if(!parseOptions(argc, argv, options)) {
+    usage();
+  }
+  std::mt19937 random(options.seed);
+  Counts counts[PATHS];
+
+  checkTable(counts, { 0, 1023 }, { 0, 255 });
+  checkTable(counts, { 0, 4095 }, { 0, 255 });
+  checkTable(counts, { 0, 100 }, { 0, 255 });
+  checkTable(counts, { 10, 200, 500, 900, 1000 }, { 0, 0, 128, 255, 255 });
+  checkTable(counts, { 0, 300, 310, 1023 }, { 20, 100, 100, 240 });
+
+  for(int t = 0; t < options.tables; t++) {
+    int size = 2 + random() % 15;
+    int top = random() % 2 ? 1023 : 4095;
+    std::vector<int> in(size), out(size);
+    in[0] = random() % 64;
+    out[0] = random() % 32;
+    for(int i = 1; i < size; i++) {
+      int room = top - in[i - 1] - (size - 1 - i);
+      in[i] = in[i - 1] + 1 + random() % (room > 1 ? room / 2 : 1);
+      // constrain() is a macro, so draw the step before using it
+      int step = random() % 4 == 0 ? 0 : random() % 64;
+      out[i] = constrain(out[i - 1] + step, 0, 255);
+    }
+    checkTable(counts, in, out);
+  }
+
+  checkMinMax(counts[MIN_MAX], 0, 1023, 0, 255);
+  checkMinMax(counts[MIN_MAX], 0, 1023, 255, 0);
+  checkMinMax(counts[MIN_MAX], 1023, 0, 0, 100);
+  checkMinMax(counts[MIN_MAX], 0, 4095, 0, 1000);
+  checkMinMax(counts[MIN_MAX], 0, 100, 0, 255);
+  checkMinMax(counts[MIN_MAX], 0, 1023, -50, 50);
+
+  bool ok = true;
+  for(int path = 0; path < PATHS; path++) {
+    printf("%-14s %8llu outputs checked, %llu round trip failures, %llu not the first raw value\n", pathNames[path],
+      counts[path].checked, counts[path].roundTrip, counts[path].notFirst);
+    ok &= counts[path].roundTrip == 0 && counts[path].notFirst == 0;
+  }
+  unsigned long long failedBegin = checkFailedBegin();
+  printf("%llu of 4 failed begin calls left the previous table behind\n", failedBegin);
+  return ok && failedBegin == 0 ? 0 : 1;
+}
@@ -0,0 +1,106 @@
+/*
+ * rar_multi_check.cpp
+ * Checks that every lane of ResponsiveAnalogReadMulti matches a separate ResponsiveAnalogRead bit for bit
+ *
+ * Each lane gets its own settings (snap multipliers from 0.001 to 1, activity thresholds from 1 to 16, sleep on and
+ * off) and a ResponsiveAnalogRead is set up the same way beside it. Both are fed the same samples from rar_signal.h,
+ * noisy knob gestures with hum and PWM spikes, first as a 10 bit and then as a 12 bit ADC, and after every update
+ * the value, the changed flag and the sleeping flag of every lane are compared. Mismatches are counted per lane,
+ * the exit status is non-zero if there were any.
+ *
+ * Build: g++ -O2 -std=c++11 -pthread -I. -I../../src -o rar_multi_check rar_multi_check.cpp ../../src/Responsive*.cpp
+ *        add -DRESPONSIVE_MULTI_LANES=16 (and -O3 -march=native for the vectorised build rar_sweep uses) to check 16 lanes
+ * Usage: rar_multi_check [-n samples] [-s seed]
+ *
+ * Copyright (c) 2016 Damien Clarke
+ * Licensed under the MIT License (MIT), see LICENSE
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "ResponsiveAnalogRead.h"
+#include "ResponsiveAnalogReadMulti.h"
+#include "rar_signal.h"
+
+static void usage()
+{
+  fprintf(stderr, "usage: rar_multi_check [-n samples] [-s seed]\n");
+  exit(2);
+}
+
+// runs one signal through every lane and its reference filter, adding mismatches per lane to mismatches
+static unsigned long long check(int bits, size_t samples, uint64_t seed, std::vector<unsigned long long>& mismatches)
+{
+  const float snaps[] = { 0.001, 0.01, 0.05, 0.1, 0.3, 1.0 };
+  const float thresholds[] = { 1.0, 2.0, 4.0, 8.0, 16.0 };
+  uint8_t lanes = RESPONSIVE_MULTI_LANES;
+
+  RarSignalConfig config;
+  config.bits = bits;
+  config.whiteNoise = bits > 10 ? 4.0 : 1.5;
+  config.hum = 2.0;
+  config.pwmAmplitude = 8.0;
+  config.gestureInterval = 800.0;
+  RarSignal signal(config, seed);
+
+  ResponsiveAnalogReadMulti multi(0, lanes);
+  multi.setAnalogResolution(signal.getMaxCode() + 1);
+  std::vector<ResponsiveAnalogRead> references(lanes);
+  for(uint8_t lane = 0; lane < lanes; lane++) {
+    bool sleepEnable = lane % 3 != 2;
+    float snap = snaps[lane % (sizeof(snaps) / sizeof(snaps[0]))];
+    float threshold = thresholds[lane % (sizeof(thresholds) / sizeof(thresholds[0]))];
+    multi.setLane(lane, sleepEnable, snap, threshold);
+    references[lane].begin(0, sleepEnable, snap);
+    references[lane].setActivityThreshold(threshold);
+    references[lane].setAnalogResolution(signal.getMaxCode() + 1);
+  }
+
+  unsigned long long changes = 0;
+  for(size_t i = 0; i < samples; i++) {
+    int sample = signal.next();
+    multi.update(sample);
+    for(uint8_t lane = 0; lane < lanes; lane++) {
+      ResponsiveAnalogRead& reference = references[lane];
+      reference.update(sample);
+      if(reference.getValue() != multi.getValue(lane) || reference.hasChanged() != multi.hasChanged(lane)
+        || reference.isSleeping() != multi.isSleeping(lane)) {
+        mismatches[lane]++;
+      }
+      changes += reference.hasChanged();
+    }
+  }
+  return changes;
+}
+
+int main(int argc, char** argv)
+{
+  size_t samples = 2000000;
+  uint64_t seed = 1;
+  for(int i = 1; i + 1 < argc; i += 2) {
+    const char* value = argv[i + 1];
+    if(strcmp(argv[i], "-n") == 0) samples = strtoul(value, NULL, 10);
+    else if(strcmp(argv[i], "-s") == 0) seed = strtoull(value, NULL, 10);
+    else usage();
+  }
+  if(argc % 2 == 0 || samples == 0) {
+    usage();
+  }
+
+  std::vector<unsigned long long> mismatches(RESPONSIVE_MULTI_LANES, 0);
+  unsigned long long changes = check(10, samples, seed, mismatches) + check(12, samples, seed + 1, mismatches);
+
+  unsigned long long total = 0;
+  for(int lane = 0; lane < RESPONSIVE_MULTI_LANES; lane++) {
+    if(mismatches[lane]) {
+      printf("lane %d: %llu mismatched updates\n", lane, mismatches[lane]);
+    }
+    total += mismatches[lane];
+  }
+  printf("%d lanes, %zu samples at 10 and 12 bits, %llu value changes, %llu mismatched updates\n", RESPONSIVE_MULTI_LANES,
+    samples, changes, total);
+  return total == 0 ? 0 : 1;
+}
@@ -0,0 +1,357 @@
+/*
+ * rar_regmap_sim.cpp
+ * Runs ResponsiveRegisterMap against a simulated I2C host to check the register protocol on Linux
+ *
+ * One thread plays the peripheral's loop: it feeds random pot movements through a ResponsiveAnalogBank and
+ * publishes every frame. Another plays the bus: it calls the transport handlers byte by byte with the
+ * interrupt lock held, the way the peripheral's interrupt would, and the loop runs in between bytes.
+ * The host side reads the frame counter, changed mask and every value in one transaction and checks that
+ *   - all values belong to the frame the counter names (no torn frames),
+ *   - every value that differs from the previous read has its changed bit set (no missed changes),
+ *   - config it writes reads back and reaches the channels (switching sleep off lets noise on still pots through).
+ * Before that, a single threaded check has one channel change in exactly one frame and then rest, with a host read
+ * landing between publish()'s two critical sections, and checks that the change still shows in the changed mask.
+ * The counts are printed at the end, the exit status is non-zero if any check failed.
+ *
+ * Build: g++ -O2 -std=c++11 -pthread -I. -I../../src -o rar_regmap_sim rar_regmap_sim.cpp ../../src/Responsive*.cpp
+ * Usage: rar_regmap_sim [-c channels] [-d seconds] [-m movingChannels] [-b byteMicros]
+ *        set RAR_TRACE=trace.json to record a timeline of scans and transactions, see rar_trace.h
+ *
+ * Copyright (c) 2016 Damien Clarke
+ * Licensed under the MIT License (MIT), see LICENSE
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+#include "ResponsiveRegisterMap.h"
+#include "rar_trace.h"
+
+// frames the scanner remembers for the host to check against, far more than the host can fall behind
+#define HISTORY 4096
+
+struct Options
+{
+  int channels = 32;
+  int seconds = 2;
+  int moving = 4;
+  int byteMicros = 25; // one byte at 400kHz I2C
+};
+
+static void usage()
+{
+  fprintf(stderr, "usage: rar_regmap_sim [-c channels] [-d seconds] [-m movingChannels] [-b byteMicros]\n");
+  exit(2);
+}
+
+static bool parseOptions(int argc, char** argv, Options& options)
+{
+  for(int i = 1; i + 1 < argc; i += 2) {
+    const char* value = argv[i + 1];
+    if(strcmp(argv[i], "-c") == 0) options.channels = atoi(value);
+    else if(strcmp(argv[i], "-d") == 0) options.seconds = atoi(value);
+    else if(strcmp(argv[i], "-m") == 0) options.moving = atoi(value);
+    else if(strcmp(argv[i], "-b") == 0) options.byteMicros = atoi(value);
+    else return false;
+  }
+  return argc % 2 == 1 && options.channels > 0 && options.channels <= RESPONSIVE_REGISTER_CHANNELS
+    && options.moving >= 0 && options.moving <= options.channels && options.seconds > 0 && options.byteMicros >= 0;
+}
+
+// the peripheral's loop: scan, filter, remember what was published for the checks, publish
+class Scanner
+{
+  public:
+    Scanner(const Options& options) : channels(options.channels), history(HISTORY * options.channels), moving(options.moving) {
+      for(size_t i = 0; i < channels.size(); i++) {
+        channels[i].begin(0, true, 0.01);
+      }
+      bank.begin(channels.data(), channels.size());
+      map.begin(bank);
+      positions.assign(channels.size(), 512);
+    }
+
+    void scan(std::mt19937& random) {
+      RAR_TRACE_SCOPE("scan");
+      std::vector<int> frame(channels.size());
+      for(size_t i = 0; i < channels.size(); i++) {
+        if((int)i < moving) {
+          positions[i] = constrain(positions[i] + (int)(random() % 9) - 4, 0, 1023);
+        }
+        frame[i] = constrain(positions[i] + (int)(random() % 5) - 2, 0, 1023);
+      }
+      bank.update(frame.data());
+
+      // publish() numbers frames from 1 and the counter register is 16 bits wide
+      uint16_t number = ++published;
+      {
+        std::lock_guard<std::mutex> lock(historyLock);
+        for(size_t i = 0; i < channels.size(); i++) {
+          history[(number % HISTORY) * channels.size() + i] = bank.getValue(i);
+        }
+      }
+      map.publish();
+    }
+
+    bool matches(uint16_t number, const uint16_t* values) {
+      std::lock_guard<std::mutex> lock(historyLock);
+      return memcmp(&history[(number % HISTORY) * channels.size()], values, channels.size() * sizeof(uint16_t)) == 0;
+    }
+
+    ResponsiveRegisterMap map;
+    ResponsiveAnalogBank bank;
+
+  private:
+    std::vector<ResponsiveAnalogRead> channels;
+    std::vector<uint16_t> history;
+    std::mutex historyLock;
+    std::vector<int> positions;
+    int moving;
+    uint16_t published = 0;
+};
+
+// the bus: every handler call runs with the interrupt lock held, and the loop may run while the next byte is on the wire
+class Bus
+{
+  public:
+    Bus(ResponsiveRegisterMap& map, int byteMicros) : map(map), byteMicros(byteMicros) {}
+
+    void writeRegisters(uint8_t address, const uint8_t* data, uint8_t length) {
+      handler([&]() { map.beginTransaction(); });
+      handler([&]() { map.write(address); });
+      for(uint8_t i = 0; i < length; i++) {
+        handler([&]() { map.write(data[i]); });
+      }
+      handler([&]() { map.endTransaction(); });
+    }
+
+    // write the address, repeated start, read length bytes
+    void readRegisters(uint8_t address, uint8_t* data, uint8_t length) {
+      handler([&]() { map.beginTransaction(); });
+      handler([&]() { map.write(address); });
+      handler([&]() { map.endTransaction(); map.beginTransaction(); });
+      for(uint8_t i = 0; i < length; i++) {
+        handler([&]() { data[i] = map.read(); });
+      }
+      handler([&]() { map.endTransaction(); });
+    }
+
+    unsigned long long transactions = 0;
+
+  private:
+    ResponsiveRegisterMap& map;
+    int byteMicros;
+
+    template<typename Handler> void handler(Handler run) {
+      {
+        std::lock_guard<std::mutex> irq(rarHostInterruptLock());
+        run();
+      }
+      if(byteMicros) {
+        std::this_thread::sleep_for(std::chrono::microseconds(byteMicros));
+      }
+    }
+};
+
+// a host transaction run straight from a pending interrupt, without the bus: the frame, changed mask and values
+struct HostRead
+{
+  uint16_t frame;
+  uint8_t changed[RESPONSIVE_REGISTER_CHANNELS / 8];
+  uint16_t values[RESPONSIVE_REGISTER_CHANNELS];
+};
+
+static ResponsiveRegisterMap* pendingMap = NULL;
+static int pendingCount = 0;
+static HostRead pendingRead;
+
+static void hostRead(ResponsiveRegisterMap& map, int count, HostRead& out)
+{
+  map.beginTransaction();
+  map.write(RESPONSIVE_REGISTER_FRAME);
+  out.frame = map.read() | (map.read() << 8);
+  map.endTransaction();
+  map.beginTransaction();
+  map.write(RESPONSIVE_REGISTER_CHANGED);
+  for(int i = 0; i < RESPONSIVE_REGISTER_CHANNELS / 8; i++) {
+    out.changed[i] = map.read();
+  }
+  map.endTransaction();
+  map.beginTransaction();
+  map.write(RESPONSIVE_REGISTER_VALUES);
+  for(int i = 0; i < count; i++) {
+    out.values[i] = map.read() | (map.read() << 8);
+  }
+  map.endTransaction();
+}
+
+static void pendingHostRead()
+{
+  hostRead(*pendingMap, pendingCount, pendingRead);
+}
+
+// each channel in turn steps once and rests. The host reads the frame before the step from inside publish(), right
+// after its first critical section, then reads again two frames later: the stepped value must carry its changed bit
+static unsigned long long checkSingleFrameChange()
+{
+  const int count = 8;
+  ResponsiveAnalogRead channels[count];
+  for(int i = 0; i < count; i++) {
+    channels[i].begin(0, true, 1.0); // snap multiplier 1 takes a step in a single update
+  }
+  ResponsiveAnalogBank bank;
+  bank.begin(channels, count);
+  ResponsiveRegisterMap map;
+  map.begin(bank);
+  pendingMap = &map;
+  pendingCount = count;
+
+  int inputs[count];
+  for(int i = 0; i < count; i++) {
+    inputs[i] = 300;
+  }
+  unsigned long long missed = 0;
+  HostRead later;
+  for(int step = 0; step < count; step++) {
+    // settle and let the host acknowledge everything so far
+    for(int frame = 0; frame < 3; frame++) {
+      bank.update(inputs);
+      map.publish();
+      hostRead(map, count, later);
+    }
+
+    inputs[step] += 200;
+    bank.update(inputs);
+    rarHostPendingInterrupt() = pendingHostRead;
+    map.publish();
+    bank.update(inputs);
+    map.publish();
+    hostRead(map, count, later);
+
+    uint8_t bit = 1 << (step & 7);
+    if(later.values[step] == pendingRead.values[step] || !(later.changed[step >> 3] & bit)) {
+      missed++;
+    }
+  }
+  return missed;
+}
+
+int main(int argc, char** argv)
+{
+  Options options;
+  if(!parseOptions(argc, argv, options)) {
+    usage();
+  }
+  rarTraceBegin(getenv("RAR_TRACE"));
+  unsigned long long singleFrameMissed = checkSingleFrameChange();
+
+  Scanner scanner(options);
+  Bus bus(scanner.map, options.byteMicros);
+  std::atomic<bool> running(true);
+  std::atomic<unsigned long long> scans(0);
+
+  std::thread loop([&]() {
+    std::mt19937 random(1);
+    while(running) {
+      scanner.scan(random);
+      scans++;
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+  });
+
+  int count = options.channels;
+  unsigned long long reads = 0, torn = 0, missed = 0, stale = 0, configErrors = 0;
+  std::vector<uint16_t> last(count, 0);
+  bool haveLast = false;
+
+  uint8_t header[3];
+  bus.readRegisters(RESPONSIVE_REGISTER_ID, header, sizeof(header));
+  if(header[0] != RESPONSIVE_REGISTER_ID_VALUE || header[2] != count) {
+    fprintf(stderr, "bad id %02x or channel count %d\n", header[0], header[2]);
+    configErrors++;
+  }
+
+  unsigned long half = millis() + options.seconds * 500UL;
+  unsigned long end = half + options.seconds * 500UL;
+  uint16_t lastFrame = 0;
+  uint16_t configFrame = 0;
+  unsigned long long noiseChanges[2] = { 0, 0 }, noiseReads[2] = { 0, 0 };
+  while(millis() < end) {
+    RAR_TRACE_SCOPE("transaction");
+    // frame counter through the sleeping mask in one transaction, then the values in the next
+    // would not be consistent with each other, so read everything from 0x04 to the last value at once
+    uint8_t registers[256];
+    uint8_t length = RESPONSIVE_REGISTER_VALUES + 2 * count - RESPONSIVE_REGISTER_FRAME;
+    bus.readRegisters(RESPONSIVE_REGISTER_FRAME, registers + RESPONSIVE_REGISTER_FRAME, length);
+    reads++;
+
+    uint16_t frame = registers[RESPONSIVE_REGISTER_FRAME] | (registers[RESPONSIVE_REGISTER_FRAME + 1] << 8);
+    std::vector<uint16_t> values(count);
+    for(int i = 0; i < count; i++) {
+      values[i] = registers[RESPONSIVE_REGISTER_VALUES + 2 * i] | (registers[RESPONSIVE_REGISTER_VALUES + 2 * i + 1] << 8);
+    }
+    if(frame == 0) {
+      continue; // nothing published yet
+    }
+    if(!scanner.matches(frame, values.data())) {
+      torn++;
+    }
+    if(frame == lastFrame) {
+      stale++;
+    }
+    lastFrame = frame;
+
+    if(haveLast) {
+      for(int i = 0; i < count; i++) {
+        bool changedBit = registers[RESPONSIVE_REGISTER_CHANGED + (i >> 3)] & (1 << (i & 7));
+        if(values[i] != last[i] && !changedBit) {
+          missed++;
+        }
+      }
+    }
+    last = values;
+    haveLast = true;
+
+    // channels that aren't moving only see noise below the activity threshold, once sleep is off it shows
+    for(int i = options.moving; i < count; i++) {
+      if(registers[RESPONSIVE_REGISTER_CHANGED + (i >> 3)] & (1 << (i & 7))) {
+        noiseChanges[configFrame ? 1 : 0]++;
+      }
+    }
+    noiseReads[configFrame ? 1 : 0]++;
+
+    // halfway through, switch sleep off and tighten the threshold from the host
+    if(!configFrame && millis() > half) {
+      uint8_t config[4] = { RESPONSIVE_REGISTER_EDGE_SNAP, 2, 0x00, 0x08 }; // snap multiplier 2048/65536
+      bus.writeRegisters(RESPONSIVE_REGISTER_CONFIG, config, sizeof(config));
+      uint8_t readBack[4];
+      bus.readRegisters(RESPONSIVE_REGISTER_CONFIG, readBack, sizeof(readBack));
+      if(memcmp(config, readBack, sizeof(config)) != 0) {
+        configErrors++;
+      }
+      configFrame = frame;
+    }
+  }
+
+  running = false;
+  loop.join();
+  // with sleep on, noise on a still pot should hardly ever get through, with it off it should get through often
+  double noiseBefore = noiseReads[0] ? (double)noiseChanges[0] / noiseReads[0] : 0.0;
+  double noiseAfter = noiseReads[1] ? (double)noiseChanges[1] / noiseReads[1] : 0.0;
+  if(options.moving < count && noiseAfter <= noiseBefore) {
+    configErrors++;
+  }
+
+  printf("%llu scans, %llu reads (%llu repeated a frame), %llu torn frames, %llu missed changes, %llu config errors\n",
+    scans.load(), reads, stale, torn, missed, configErrors);
+  printf("still channels changed per read: %.3f with sleep, %.3f without\n", noiseBefore, noiseAfter);
+  printf("%llu single frame changes missed\n", singleFrameMissed);
+  bool traced = rarTraceEnd();
+  return torn == 0 && missed == 0 && configErrors == 0 && singleFrameMissed == 0 && traced ? 0 : 1;
+}
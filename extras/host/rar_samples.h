@@ -0,0 +1,109 @@
+/*
+ * rar_samples.h
+ * Raw sample parsing shared by the host tools
+ *
+ * Samples are either whitespace separated text integers or binary little endian int16.
+ * Both parsers take a stream in arbitrary blocks and carry partial samples over to the next block.
+ *
+ * Copyright (c) 2016 Damien Clarke
+ * Licensed under the MIT License (MIT), see LICENSE
+ */
+
+#ifndef RAR_SAMPLES_H
+#define RAR_SAMPLES_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <vector>
+
+class RarSampleParser
+{
+  public:
+    explicit RarSampleParser(bool binary) : binary(binary) {}
+
+    // calls sink(int) for every complete sample in the block
+    template<typename Sink> void parse(const uint8_t* data, size_t length, Sink& sink) {
+      if(binary) {
+        parseBinary(data, length, sink);
+      } else {
+        parseText(data, length, sink);
+      }
+    }
+
+    // flush a text sample that ended at the end of the stream without a separator
+    template<typename Sink> void finish(Sink& sink) {
+      if(inNumber) {
+        sink(negative ? -value : value);
+      }
+      inNumber = false;
+      value = 0;
+      negative = false;
+      hasLowByte = false;
+    }
+
+  private:
+    bool binary;
+    // text state
+    int value = 0;
+    bool negative = false;
+    bool inNumber = false;
+    // binary state
+    uint8_t lowByte = 0;
+    bool hasLowByte = false;
+
+    template<typename Sink> void parseBinary(const uint8_t* data, size_t length, Sink& sink) {
+      size_t i = 0;
+      if(hasLowByte && length) {
+        sink((int)(int16_t)(lowByte | (data[0] << 8)));
+        hasLowByte = false;
+        i = 1;
+      }
+      for(; i + 1 < length; i += 2) {
+        sink((int)(int16_t)(data[i] | (data[i + 1] << 8)));
+      }
+      if(i < length) {
+        lowByte = data[i];
+        hasLowByte = true;
+      }
+    }
+
+    template<typename Sink> void parseText(const uint8_t* data, size_t length, Sink& sink) {
+      for(size_t i = 0; i < length; i++) {
+        uint8_t c = data[i];
+        if(c >= '0' && c <= '9') {
+          value = value * 10 + (c - '0');
+          inNumber = true;
+        } else if(c == '-' && !inNumber) {
+          negative = true;
+        } else {
+          if(inNumber) {
+            sink(negative ? -value : value);
+          }
+          value = 0;
+          negative = false;
+          inNumber = false;
+        }
+      }
+    }
+};
+
+// read a whole stream into one vector of samples, for tools that need random access
+inline bool rarReadAllSamples(FILE* in, bool binary, std::vector<int>& samples)
+{
+  struct Append {
+    std::vector<int>& samples;
+    void operator()(int sample) { samples.push_back(sample); }
+  } append = { samples };
+
+  RarSampleParser parser(binary);
+  std::vector<uint8_t> block(1 << 20);
+  size_t n;
+  while((n = fread(block.data(), 1, block.size(), in)) > 0) {
+    parser.parse(block.data(), n, append);
+  }
+  parser.finish(append);
+  return !ferror(in);
+}
+
+#endif
@@ -0,0 +1,278 @@
+/*
+ * rar_signal.h
+ * Seeded synthetic potentiometer signals for benchmarks and quality checks
+ *
+ * A signal is built per sample as
+ *   knob gesture -> supply sag -> noise (white, pink, brown, mains hum) -> PWM spikes -> ADC with INL -> code
+ * Everything comes from one PCG32 stream and lookup tables filled in the constructor, so the same seed always gives
+ * the same samples on any host, and a sample costs one random draw and a few multiply-adds. Ground truth (the
+ * noiseless knob position in codes) is kept alongside, so quality metrics can compare against what was really meant.
+ *
+ *   RarSignalConfig config;
+ *   config.whiteNoise = 1.5;
+ *   RarSignal signal(config, 42);
+ *   signal.fill(samples, count);
+ *
+ * Copyright (c) 2016 Damien Clarke
+ * Licensed under the MIT License (MIT), see LICENSE
+ */
+
+#ifndef RAR_SIGNAL_H
+#define RAR_SIGNAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <math.h>
+#include <vector>
+
+// PCG32, XSH RR variant (pcg-random.org): small state, good statistics and far cheaper than std::mt19937
+class RarPcg32
+{
+  public:
+    explicit RarPcg32(uint64_t seed, uint64_t stream = 54) : state(0), increment((stream << 1) | 1) {
+      next();
+      state += seed;
+      next();
+    }
+
+    inline uint32_t next() {
+      uint64_t old = state;
+      state = old * 6364136223846793005ULL + increment;
+      uint32_t xorShifted = (uint32_t)(((old >> 18) ^ old) >> 27);
+      uint32_t rotation = (uint32_t)(old >> 59);
+      return (xorShifted >> rotation) | (xorShifted << ((32 - rotation) & 31));
+    }
+
+    // uniform in [0, 1)
+    inline float uniform() { return (next() >> 8) * (1.0f / 16777216.0f); }
+
+    // roughly normal with mean 0 and standard deviation 1: the sum of the four bytes of one draw (Irwin-Hall),
+    // within 3 sigma of a true gaussian, which is all an ADC noise model needs
+    inline float gaussian() {
+      uint32_t r = next();
+      int sum = (r & 0xFF) + ((r >> 8) & 0xFF) + ((r >> 16) & 0xFF) + (r >> 24);
+      return (sum - 510) * (1.0f / 147.8f);
+    }
+
+  private:
+    uint64_t state;
+    uint64_t increment;
+};
+
+struct RarSignalConfig
+{
+  // ADC
+  int bits = 10;
+  float inl = 0.5; // peak integral nonlinearity in LSB, a bow across the range
+  float dnl = 0.2; // random per-code step error in LSB
+
+  // noise, all in LSB
+  float whiteNoise = 1.0; // standard deviation
+  float pinkNoise = 0.0; // 1/f, standard deviation roughly
+  float brownNoise = 0.0; // random walk step, leaks back to zero
+  float hum = 0.0; // mains amplitude
+  float humHz = 50.0;
+  float sampleHz = 1000.0;
+
+  // PWM (LED or motor drivers sharing the ground): a spike of pwmAmplitude LSB lasting pwmWidth samples every pwmPeriod samples
+  float pwmAmplitude = 0.0;
+  float pwmPeriod = 97.3;
+  int pwmWidth = 1;
+
+  // supply sag: drops of up to sagDepth (fraction of the reading) every sagInterval samples on average,
+  // recovering with a time constant of sagRecovery samples. Zero depth means a ratiometric board
+  float sagDepth = 0.0;
+  float sagInterval = 5000.0;
+  float sagRecovery = 50.0;
+
+  // gestures: on average a move every gestureInterval samples, taking gestureLength samples
+  float gestureInterval = 2000.0;
+  float gestureLength = 300.0;
+};
+
+// gesture shapes, 0 to 1 over 17 evenly spaced points from start to end of a move
+enum RarGesture
+{
+  RAR_GESTURE_SWEEP,     // smooth ease in and out, a deliberate turn
+  RAR_GESTURE_FLICK,     // fast start, long tail
+  RAR_GESTURE_OVERSHOOT, // passes the target and settles back
+  RAR_GESTURE_NUDGE,     // hesitant fine adjustment
+  RAR_GESTURE_COUNT
+};
+
+static const float rarGestureShapes[RAR_GESTURE_COUNT][17] = {
+  { 0.000f, 0.010f, 0.038f, 0.084f, 0.146f, 0.222f, 0.309f, 0.402f, 0.500f, 0.598f, 0.691f, 0.778f, 0.854f, 0.916f, 0.962f, 0.990f, 1.000f },
+  { 0.000f, 0.300f, 0.520f, 0.670f, 0.770f, 0.840f, 0.890f, 0.925f, 0.950f, 0.967f, 0.979f, 0.987f, 0.992f, 0.995f, 0.997f, 0.999f, 1.000f },
+  { 0.000f, 0.040f, 0.160f, 0.360f, 0.600f, 0.820f, 0.980f, 1.080f, 1.120f, 1.110f, 1.070f, 1.030f, 1.005f, 0.995f, 0.995f, 0.998f, 1.000f },
+  { 0.000f, 0.050f, 0.150f, 0.200f, 0.200f, 0.250f, 0.400f, 0.450f, 0.450f, 0.500f, 0.650f, 0.700f, 0.700f, 0.800f, 0.950f, 1.000f, 1.000f },
+};
+
+class RarSignal
+{
+  public:
+    RarSignal(const RarSignalConfig& config, uint64_t seed, uint64_t stream = 54) : config(config), random(seed, stream) {
+      maxCode = (1 << config.bits) - 1;
+
+      // transfer curve: the input level in LSB where each code starts, with a bow shaped INL and a fixed random
+      // error per code. The ends are open so quantize() needs no range checks
+      transitions.resize(maxCode + 2);
+      for(int code = 0; code <= maxCode; code++) {
+        float x = (float)code / maxCode;
+        float bow = config.inl * 4.0f * x * (1.0f - x);
+        transitions[code] = code + bow + config.dnl * (random.uniform() - 0.5f) * 2.0f;
+      }
+      transitions[0] = -HUGE_VALF;
+      transitions[maxCode + 1] = HUGE_VALF;
+
+      // one sine period, so hum needs no sin() per sample
+      for(int i = 0; i < 256; i++) {
+        sine[i] = sinf(i * 6.2831853f / 256.0f);
+      }
+      humStep = config.humHz / config.sampleHz * 256.0f;
+      sagDecay = config.sagRecovery > 0.0f ? expf(-1.0f / config.sagRecovery) : 0.0f;
+      brownLeak = 0.999f;
+
+      position = target = start = maxCode * random.uniform();
+      rest = interval(config.gestureInterval);
+      sagIn = interval(config.sagInterval);
+    }
+
+    // next sample as an ADC code
+    inline int next() {
+      float knob = gesture();
+      truth = knob;
+
+      // supply sag scales the whole reading
+      if(config.sagDepth > 0.0f) {
+        if(--sagIn == 0) {
+          sag = config.sagDepth * random.uniform();
+          sagIn = interval(config.sagInterval);
+        }
+        knob *= 1.0f - sag;
+        // stop at zero rather than decaying into denormals, which are dozens of times slower
+        sag = sag > 1e-6f ? sag * sagDecay : 0.0f;
+      }
+
+      float noise = config.whiteNoise * random.gaussian();
+      if(config.pinkNoise > 0.0f) {
+        // Paul Kellet's economy pink filter
+        float white = random.gaussian();
+        pink0 = 0.99765f * pink0 + white * 0.0990460f;
+        pink1 = 0.96300f * pink1 + white * 0.2965164f;
+        pink2 = 0.57000f * pink2 + white * 1.0526913f;
+        noise += config.pinkNoise * 0.25f * (pink0 + pink1 + pink2 + white * 0.1848f);
+      }
+      if(config.brownNoise > 0.0f) {
+        brown = brown * brownLeak + config.brownNoise * random.gaussian();
+        noise += brown;
+      }
+      if(config.hum > 0.0f) {
+        noise += config.hum * sine[(uint8_t)humPhase];
+        humPhase += humStep;
+        if(humPhase >= 256.0f) humPhase -= 256.0f;
+      }
+      if(config.pwmAmplitude > 0.0f) {
+        if(pwmPhase < config.pwmWidth) {
+          noise += config.pwmAmplitude;
+        }
+        pwmPhase += 1.0f;
+        if(pwmPhase >= config.pwmPeriod) pwmPhase -= config.pwmPeriod;
+      }
+
+      return quantize(knob + noise);
+    }
+
+    void fill(int* out, size_t count) {
+      for(size_t i = 0; i < count; i++) {
+        out[i] = next();
+      }
+    }
+
+    // also record the noiseless knob position, in codes, for each sample
+    void fill(int* out, float* truths, size_t count) {
+      for(size_t i = 0; i < count; i++) {
+        out[i] = next();
+        truths[i] = truth;
+      }
+    }
+
+    inline float getTruth() { return truth; }
+    inline int getMaxCode() { return maxCode; }
+
+  private:
+    RarSignalConfig config;
+    RarPcg32 random;
+    int maxCode;
+    std::vector<float> transitions;
+    float sine[256];
+
+    // gesture state: moving from start to target along shape, or resting until rest runs out
+    float position = 0.0;
+    float start = 0.0;
+    float target = 0.0;
+    const float* shape = rarGestureShapes[0];
+    float progress = 0.0; // 0 to 16 along the shape table
+    float progressStep = 0.0;
+    bool moving = false;
+    uint32_t rest = 1; // samples until the next move
+    float truth = 0.0;
+
+    float sag = 0.0;
+    uint32_t sagIn = 1; // samples until the next sag
+    float sagDecay;
+    float pink0 = 0.0, pink1 = 0.0, pink2 = 0.0;
+    float brown = 0.0;
+    float brownLeak;
+    float humPhase = 0.0;
+    float humStep;
+    float pwmPhase = 0.0;
+
+    // events arrive at random with the given average spacing: exponentially distributed gaps, drawn once per event
+    // instead of a random test every sample
+    inline uint32_t interval(float average) {
+      return 1 + (uint32_t)(-logf(1.0f - random.uniform()) * average);
+    }
+
+    inline float gesture() {
+      if(!moving) {
+        if(--rest) {
+          return position;
+        }
+        // pick the next move: a shape, a target and a length of half to one and a half times the average
+        uint32_t r = random.next();
+        shape = rarGestureShapes[r % RAR_GESTURE_COUNT];
+        start = position;
+        target = maxCode * random.uniform();
+        progressStep = 16.0f / (config.gestureLength * (0.5f + random.uniform()));
+        progress = 0.0;
+        moving = true;
+      }
+
+      progress += progressStep;
+      if(progress >= 16.0f) {
+        moving = false;
+        rest = interval(config.gestureInterval);
+        position = target;
+        return position;
+      }
+      int index = (int)progress;
+      float fraction = progress - index;
+      float along = shape[index] + (shape[index + 1] - shape[index]) * fraction;
+      position = start + (target - start) * along;
+      return position;
+    }
+
+    // find the code whose transition level the input has passed. Transitions sit within a code of their ideal place,
+    // so only the neighbours of the ideal code need checking. Noise makes those checks unpredictable, so they are
+    // done as arithmetic rather than branches
+    inline int quantize(float input) {
+      float level = input + 0.5f;
+      int code = (int)level;
+      code = code < 0 ? 0 : (code > maxCode ? maxCode : code);
+      code -= level < transitions[code];
+      code += level >= transitions[code + 1];
+      return code;
+    }
+};
+
+#endif
@@ -0,0 +1,142 @@
+/*
+ * rar_sweep.cpp
+ * Replays one recorded channel against a grid of (snapMultiplier, activityThreshold) settings
+ *
+ * Settings are packed 16 at a time into the lanes of a ResponsiveAnalogReadMulti, so one pass over the
+ * trace evaluates 16 configurations. For each one a CSV line is written to stdout:
+ *   snapMultiplier,activityThreshold,sleep,changes,meanAbsError,sleepingFraction
+ * changes counts value changes (lower is quieter), meanAbsError is the average distance from the raw input
+ * (lower is more accurate and less laggy) and sleepingFraction the share of samples spent asleep.
+ *
+ * Build: g++ -O3 -march=native -std=c++11 -pthread -DRESPONSIVE_MULTI_LANES=16 -I. -I../../src \
+ *          -o rar_sweep rar_sweep.cpp ../../src/Responsive*.cpp
+ *        (RESPONSIVE_MULTI_LANES must be 16 for the library sources too)
+ * Usage: rar_sweep [-b] [-n (sleep off)] [-r analogResolution] -s 0.001,0.01,0.1 -t 1,2,4,8 < trace
+ *        set RAR_TRACE=trace.json to record a timeline of the read and filter passes, see rar_trace.h
+ *
+ * Copyright (c) 2016 Damien Clarke
+ * Licensed under the MIT License (MIT), see LICENSE
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "ResponsiveAnalogReadMulti.h"
+#include "rar_samples.h"
+#include "rar_trace.h"
+
+#if RESPONSIVE_MULTI_LANES != 16
+#error "build rar_sweep and the library with -DRESPONSIVE_MULTI_LANES=16"
+#endif
+
+struct Config
+{
+  float snapMultiplier;
+  float activityThreshold;
+  unsigned long long changes;
+  double absError;
+  unsigned long long sleepingSamples;
+};
+
+static std::vector<float> parseList(const char* list)
+{
+  std::vector<float> values;
+  while(*list) {
+    char* end;
+    values.push_back(strtof(list, &end));
+    if(end == list) {
+      break;
+    }
+    list = *end == ',' ? end + 1 : end;
+  }
+  return values;
+}
+
+static void usage()
+{
+  fprintf(stderr, "usage: rar_sweep [-b] [-n] [-r analogResolution] -s snap1,snap2,... -t threshold1,threshold2,... < trace\n");
+  exit(2);
+}
+
+int main(int argc, char** argv)
+{
+  bool binary = false;
+  bool sleepEnable = true;
+  int analogResolution = 1024;
+  std::vector<float> snaps, thresholds;
+  for(int i = 1; i < argc; i++) {
+    if(strcmp(argv[i], "-b") == 0) binary = true;
+    else if(strcmp(argv[i], "-n") == 0) sleepEnable = false;
+    else if(i + 1 < argc && strcmp(argv[i], "-r") == 0) analogResolution = atoi(argv[++i]);
+    else if(i + 1 < argc && strcmp(argv[i], "-s") == 0) snaps = parseList(argv[++i]);
+    else if(i + 1 < argc && strcmp(argv[i], "-t") == 0) thresholds = parseList(argv[++i]);
+    else usage();
+  }
+  if(snaps.empty() || thresholds.empty()) {
+    usage();
+  }
+  rarTraceBegin(getenv("RAR_TRACE"));
+
+  std::vector<int> trace;
+  {
+    RAR_TRACE_SCOPE("read");
+    if(!rarReadAllSamples(stdin, binary, trace)) {
+      perror("read");
+      return 1;
+    }
+  }
+
+  std::vector<Config> configs;
+  for(size_t s = 0; s < snaps.size(); s++) {
+    for(size_t t = 0; t < thresholds.size(); t++) {
+      Config config = { snaps[s], thresholds[t], 0, 0.0, 0 };
+      configs.push_back(config);
+    }
+  }
+
+  for(size_t first = 0; first < configs.size(); first += RESPONSIVE_MULTI_LANES) {
+    RAR_TRACE_SCOPE("filter");
+    uint8_t lanes = configs.size() - first < RESPONSIVE_MULTI_LANES ? configs.size() - first : RESPONSIVE_MULTI_LANES;
+
+    ResponsiveAnalogReadMulti filter(0, lanes);
+    filter.setAnalogResolution(analogResolution);
+    for(uint8_t lane = 0; lane < lanes; lane++) {
+      filter.setLane(lane, sleepEnable, configs[first + lane].snapMultiplier, configs[first + lane].activityThreshold);
+    }
+
+    unsigned long long changes[RESPONSIVE_MULTI_LANES] = {0};
+    unsigned long long asleep[RESPONSIVE_MULTI_LANES] = {0};
+    double error[RESPONSIVE_MULTI_LANES] = {0.0};
+    for(size_t i = 0; i < trace.size(); i++) {
+      int raw = trace[i];
+      filter.update(raw);
+      uint16_t mask = filter.getChangedMask();
+      for(uint8_t lane = 0; lane < lanes; lane++) {
+        changes[lane] += (mask >> lane) & 1;
+        asleep[lane] += filter.isSleeping(lane);
+        int distance = filter.getValue(lane) - raw;
+        error[lane] += distance < 0 ? -distance : distance;
+      }
+    }
+
+    for(uint8_t lane = 0; lane < lanes; lane++) {
+      configs[first + lane].changes = changes[lane];
+      configs[first + lane].absError = error[lane];
+      configs[first + lane].sleepingSamples = asleep[lane];
+    }
+  }
+
+  printf("snapMultiplier,activityThreshold,sleep,changes,meanAbsError,sleepingFraction\n");
+  double samples = trace.empty() ? 1.0 : (double)trace.size();
+  for(size_t i = 0; i < configs.size(); i++) {
+    const Config& c = configs[i];
+    printf("%g,%g,%d,%llu,%.4f,%.4f\n", c.snapMultiplier, c.activityThreshold, sleepEnable ? 1 : 0,
+      c.changes, c.absError / samples, c.sleepingSamples / samples);
+  }
+  fprintf(stderr, "%zu samples, %zu configurations in %zu passes\n", trace.size(), configs.size(),
+    (configs.size() + RESPONSIVE_MULTI_LANES - 1) / RESPONSIVE_MULTI_LANES);
+
+  return rarTraceEnd() ? 0 : 1;
+}
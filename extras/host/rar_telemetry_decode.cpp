@@ -0,0 +1,105 @@
+/*
+ * rar_telemetry_decode.cpp
+ * Host-side decoder for ResponsiveTelemetry frames
+ *
+ * Reads a captured byte stream (a file, or a serial port configured with stty) and prints one
+ * CSV line per valid frame: time_ms,channel,raw,value,changed,sleeping
+ * The frame layout is documented in src/ResponsiveTelemetry.h.
+ *
+ * Build: g++ -O2 -std=c++11 -pthread -o rar_telemetry_decode rar_telemetry_decode.cpp
+ * Usage: rar_telemetry_decode [capture.bin]   (reads stdin when no file is given)
+ *        set RAR_TRACE=trace.json to record a timeline of the read and decode stages, see rar_trace.h
+ *
+ * Copyright (c) 2016 Damien Clarke
+ * Licensed under the MIT License (MIT), see LICENSE
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "rar_trace.h"
+
+#define FRAME_SYNC 0xA5
+#define FRAME_SIZE 12
+#define FLAG_CHANGED 0x01
+#define FLAG_SLEEPING 0x02
+
+static uint8_t crc8(const uint8_t* data, int length)
+{
+  uint8_t crc = 0;
+  while(length--) {
+    crc ^= *data++;
+    for(int i = 0; i < 8; i++) {
+      crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+int main(int argc, char** argv)
+{
+  rarTraceBegin(getenv("RAR_TRACE"));
+  FILE* in = stdin;
+  if(argc > 1) {
+    in = fopen(argv[1], "rb");
+    if(!in) {
+      perror(argv[1]);
+      return 1;
+    }
+  }
+
+  static uint8_t chunk[1 << 16];
+  uint8_t frame[FRAME_SIZE];
+  int have = 0;
+  unsigned long frames = 0, crcErrors = 0, skipped = 0;
+
+  for(;;) {
+    size_t n;
+    {
+      RAR_TRACE_SCOPE("read");
+      n = fread(chunk, 1, sizeof(chunk), in);
+    }
+    if(n == 0) {
+      break;
+    }
+
+    RAR_TRACE_SCOPE("decode");
+    for(size_t i = 0; i < n; i++) {
+      // hunt for the sync byte, then collect a whole frame
+      if(have == 0 && chunk[i] != FRAME_SYNC) {
+        skipped++;
+        continue;
+      }
+      frame[have++] = chunk[i];
+      if(have < FRAME_SIZE) {
+        continue;
+      }
+
+      if(crc8(frame + 1, FRAME_SIZE - 2) != frame[FRAME_SIZE - 1]) {
+        // bad frame, resync on the next sync byte inside it
+        crcErrors++;
+        int next = 1;
+        while(next < FRAME_SIZE && frame[next] != FRAME_SYNC) next++;
+        skipped += next;
+        have = FRAME_SIZE - next;
+        memmove(frame, frame + next, have);
+        continue;
+      }
+
+      unsigned raw = frame[2] | (frame[3] << 8);
+      unsigned value = frame[4] | (frame[5] << 8);
+      unsigned long time = (unsigned long)frame[7] | ((unsigned long)frame[8] << 8)
+        | ((unsigned long)frame[9] << 16) | ((unsigned long)frame[10] << 24);
+      printf("%lu,%u,%u,%u,%d,%d\n", time, frame[1], raw, value,
+        (frame[6] & FLAG_CHANGED) ? 1 : 0, (frame[6] & FLAG_SLEEPING) ? 1 : 0);
+      frames++;
+      have = 0;
+    }
+  }
+
+  fprintf(stderr, "%lu frames, %lu CRC errors, %lu bytes skipped\n", frames, crcErrors, skipped);
+  if(in != stdin) {
+    fclose(in);
+  }
+  return rarTraceEnd() ? 0 : 1;
+}
@@ -0,0 +1,145 @@
+/*
+ * rar_trace.h
+ * Chrome trace event recording for the host tools
+ *
+ * Scopes are recorded into a buffer owned by the recording thread, so tracing costs two clock reads and
+ * an append per scope with no locking. rarTraceEnd() writes every thread's events as Chrome trace JSON,
+ * which chrome://tracing and ui.perfetto.dev both open.
+ *
+ * Tracing is off unless rarTraceBegin() is given a path; the tools pass the RAR_TRACE environment variable:
+ *   RAR_TRACE=trace.json rar_telemetry_decode capture.bin
+ *
+ * Copyright (c) 2016 Damien Clarke
+ * Licensed under the MIT License (MIT), see LICENSE
+ */
+
+#ifndef RAR_TRACE_H
+#define RAR_TRACE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct RarTraceEvent
+{
+  const char* name; // must be a string literal, only the pointer is stored
+  uint64_t startNS;
+  uint64_t durationNS;
+};
+
+struct RarTraceThread
+{
+  unsigned id;
+  std::vector<RarTraceEvent> events;
+};
+
+struct RarTraceState
+{
+  std::mutex lock;
+  std::vector<RarTraceThread*> threads;
+  std::string path;
+  bool enabled = false;
+  std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+};
+
+inline RarTraceState& rarTraceState()
+{
+  static RarTraceState state;
+  return state;
+}
+
+inline uint64_t rarTraceNow()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - rarTraceState().origin).count();
+}
+
+// the calling thread's buffer, registered once on first use and kept until rarTraceEnd()
+inline RarTraceThread& rarTraceThread()
+{
+  static thread_local RarTraceThread* thread = NULL;
+  if(!thread) {
+    RarTraceState& state = rarTraceState();
+    std::lock_guard<std::mutex> guard(state.lock);
+    thread = new RarTraceThread();
+    thread->id = (unsigned)state.threads.size() + 1;
+    thread->events.reserve(1 << 16);
+    state.threads.push_back(thread);
+  }
+  return *thread;
+}
+
+// start tracing to path, a NULL or empty path leaves tracing off
+inline void rarTraceBegin(const char* path)
+{
+  RarTraceState& state = rarTraceState();
+  if(!path || !*path) {
+    return;
+  }
+  state.path = path;
+  state.enabled = true;
+}
+
+inline bool rarTraceEnabled()
+{
+  return rarTraceState().enabled;
+}
+
+class RarTraceScope
+{
+  public:
+    explicit RarTraceScope(const char* name) : name(name), startNS(rarTraceEnabled() ? rarTraceNow() : 0) {}
+    ~RarTraceScope() {
+      if(rarTraceEnabled()) {
+        RarTraceEvent event = { name, startNS, rarTraceNow() - startNS };
+        rarTraceThread().events.push_back(event);
+      }
+    }
+
+  private:
+    const char* name;
+    uint64_t startNS;
+};
+
+#define RAR_TRACE_CONCAT2(a, b) a##b
+#define RAR_TRACE_CONCAT(a, b) RAR_TRACE_CONCAT2(a, b)
+// record the rest of the enclosing block as one event
+#define RAR_TRACE_SCOPE(name) RarTraceScope RAR_TRACE_CONCAT(rarTraceScope, __LINE__)(name)
+
+// write all recorded events and stop tracing, call after worker threads have finished
+inline bool rarTraceEnd()
+{
+  RarTraceState& state = rarTraceState();
+  if(!state.enabled) {
+    return true;
+  }
+  state.enabled = false;
+
+  FILE* out = fopen(state.path.c_str(), "w");
+  if(!out) {
+    perror(state.path.c_str());
+    return false;
+  }
+
+  std::lock_guard<std::mutex> guard(state.lock);
+  fputs("{\"traceEvents\":[\n", out);
+  bool first = true;
+  for(size_t t = 0; t < state.threads.size(); t++) {
+    RarTraceThread* thread = state.threads[t];
+    for(size_t i = 0; i < thread->events.size(); i++) {
+      const RarTraceEvent& e = thread->events[i];
+      fprintf(out, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+        first ? "" : ",\n", e.name, thread->id, e.startNS / 1000.0, e.durationNS / 1000.0);
+      first = false;
+    }
+    thread->events.clear();
+  }
+  fputs("\n],\"displayTimeUnit\":\"ns\"}\n", out);
+  fclose(out);
+  return true;
+}
+
+#endif
@@ -0,0 +1,127 @@
+/*
+ * ResponsiveAnalogBank.cpp
+ * Runs a frame of raw readings through a group of ResponsiveAnalogRead channels in one pass
+ *
+ * Copyright (c) 2016 Damien Clarke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <Arduino.h>
+#include "ResponsiveAnalogBank.h"
+
+void ResponsiveAnalogBank::begin(ResponsiveAnalogRead* channels, uint8_t count)
+{
+  this->channels = channels;
+  this->count = count;
+  anyChanged = false;
+}
+
+void ResponsiveAnalogBank::setReference(uint8_t channel, int nominal)
+{
+  referenceChannel = channel < count ? channel : RESPONSIVE_BANK_NO_REFERENCE;
+  referenceNominal = nominal;
+}
+
+void ResponsiveAnalogBank::update(int* frame)
+{
+  uint32_t startUS = 0;
+  if(scanLatency || arrivalJitter) {
+    startUS = micros();
+    if(arrivalJitter) {
+      arrivalJitter->arrival(startUS);
+    }
+  }
+
+  if(crosstalk) {
+    crosstalk->apply(frame);
+  }
+  if(referenceChannel != RESPONSIVE_BANK_NO_REFERENCE) {
+    applyReference(frame);
+  }
+
+  // keep the per channel timing out of the plain loop so uninstrumented banks pay nothing for it
+  if(updateLatency) {
+    updateChannelsTimed(frame);
+  } else {
+    updateChannels(frame);
+  }
+
+  if(scanLatency) {
+    scanLatency->record(micros() - startUS);
+  }
+}
+
+void ResponsiveAnalogBank::updateChannels(int* frame)
+{
+  anyChanged = false;
+  for(uint8_t i = 0; i < count; i++) {
+    channels[i].update(frame[i]);
+    anyChanged |= channels[i].hasChanged();
+  }
+}
+
+void ResponsiveAnalogBank::updateChannelsTimed(int* frame)
+{
+  anyChanged = false;
+  uint32_t lastUS = micros();
+  for(uint8_t i = 0; i < count; i++) {
+    channels[i].update(frame[i]);
+    anyChanged |= channels[i].hasChanged();
+    uint32_t nowUS = micros();
+    updateLatency->record(nowUS - lastUS);
+    lastUS = nowUS;
+  }
+}
+
+void ResponsiveAnalogBank::applyReference(int* frame)
+{
+  int reference = frame[referenceChannel];
+  if(reference <= 0 || reference < referenceNominal / 2) {
+    return;
+  }
+
+  // one 16.16 fixed point gain for the whole frame, then a branch free multiply over every entry,
+  // which stays cheap on AVR and lets the compiler vectorise it on bigger cores.
+  // The gain is at most 2.0, so a 14 bit reading times the gain still fits in 32 bits. The multiply is signed,
+  // so an entry an earlier stage left slightly negative stays small instead of wrapping to full scale
+  int32_t gain = (int32_t)(((uint32_t)referenceNominal << 16) / (uint32_t)reference);
+  for(uint8_t i = 0; i < count; i++) {
+    frame[i] = (int)(((int32_t)frame[i] * gain + 0x8000) >> 16);
+  }
+
+  // the reference keeps its real reading, so it can still be used to monitor the rail
+  frame[referenceChannel] = reference;
+}
+
+#ifdef RESPONSIVE_ANALOG_READ_STATS
+void ResponsiveAnalogBank::exportStats(ResponsiveAnalogStats* table)
+{
+  for(uint8_t i = 0; i < count; i++) {
+    table[i] = channels[i].getStats();
+  }
+}
+
+void ResponsiveAnalogBank::resetStats()
+{
+  for(uint8_t i = 0; i < count; i++) {
+    channels[i].resetStats();
+  }
+}
+#endif
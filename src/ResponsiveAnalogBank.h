@@ -0,0 +1,92 @@
+/*
+ * ResponsiveAnalogBank.h
+ * Runs a frame of raw readings through a group of ResponsiveAnalogRead channels in one pass
+ *
+ * Copyright (c) 2016 Damien Clarke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef RESPONSIVE_ANALOG_BANK_H
+#define RESPONSIVE_ANALOG_BANK_H
+
+#include <Arduino.h>
+#include "ResponsiveAnalogRead.h"
+#include "ResponsiveCrosstalk.h"
+#include "ResponsiveLatency.h"
+
+#define RESPONSIVE_BANK_NO_REFERENCE 0xFF
+
+class ResponsiveAnalogBank
+{
+  public:
+
+    // channels - caller owned array of already initialised ResponsiveAnalogRead objects, one per frame entry
+    void begin(ResponsiveAnalogRead* channels, uint8_t count);
+
+    // ratiometric mode: channel measures the supply rail the pots hang off, and reads nominal when the rail is healthy
+    // every raw value in the frame is scaled by nominal / reference before filtering, so a sagging rail doesn't
+    // move (and wake) every channel at once. If the reference drops below half of nominal the frame is left unscaled
+    void setReference(uint8_t channel, int nominal);
+    inline void disableReference() { referenceChannel = RESPONSIVE_BANK_NO_REFERENCE; }
+
+    // correct multiplexer crosstalk between scan neighbours before anything else touches the frame
+    inline void setCrosstalk(ResponsiveCrosstalk* crosstalk) { this->crosstalk = crosstalk; }
+
+    // optional instrumentation, any of these can be NULL:
+    // updates - time of each channel's update(), scans - time of the whole update(frame) call,
+    // arrivals - interval between frames arriving
+    inline void setInstrumentation(ResponsiveLatencyHistogram* updates, ResponsiveLatencyHistogram* scans, ResponsiveJitter* arrivals) {
+      updateLatency = updates; scanLatency = scans; arrivalJitter = arrivals;
+    }
+
+    // frame - one raw reading per channel, in channel order. It is preprocessed in place before filtering
+    void update(int* frame);
+
+    inline uint8_t getCount() { return count; }
+    inline ResponsiveAnalogRead& getChannel(uint8_t index) { return channels[index]; }
+    inline int getValue(uint8_t index) { return channels[index].getValue(); }
+    inline bool hasChanged(uint8_t index) { return channels[index].hasChanged(); }
+    inline bool hasChanged() { return anyChanged; } // returns true if any channel changed during the last update
+
+#ifdef RESPONSIVE_ANALOG_READ_STATS
+    // copy every channel's counters into table (getCount() entries), e.g. to plan per channel scan rates
+    void exportStats(ResponsiveAnalogStats* table);
+    void resetStats();
+#endif
+
+  private:
+    ResponsiveAnalogRead* channels = NULL;
+    uint8_t count = 0;
+    bool anyChanged = false;
+
+    uint8_t referenceChannel = RESPONSIVE_BANK_NO_REFERENCE;
+    int referenceNominal = 0;
+    ResponsiveCrosstalk* crosstalk = NULL;
+    ResponsiveLatencyHistogram* updateLatency = NULL;
+    ResponsiveLatencyHistogram* scanLatency = NULL;
+    ResponsiveJitter* arrivalJitter = NULL;
+
+    void updateChannels(int* frame);
+    void updateChannelsTimed(int* frame);
+
+    void applyReference(int* frame);
+};
+
+#endif
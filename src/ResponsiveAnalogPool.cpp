@@ -0,0 +1,93 @@
+/*
+ * ResponsiveAnalogPool.cpp
+ * Fixed capacity, heap free pool of ResponsiveAnalogRead channels and their mapping tables
+ *
+ * Copyright (c) 2016 Damien Clarke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <Arduino.h>
+#include "ResponsiveAnalogPool.h"
+
+void ResponsiveAnalogPool::begin(ResponsiveAnalogSlot* slots, uint8_t capacity)
+{
+  if(capacity >= RESPONSIVE_POOL_END) {
+    capacity = RESPONSIVE_POOL_END - 1;
+  }
+  this->slots = slots;
+  this->capacity = capacity;
+  used = 0;
+  peak = 0;
+  failures = 0;
+
+  // thread every slot onto the free list in order
+  for(uint8_t i = 0; i < capacity; i++) {
+    slots[i].nextFree = i + 1 < capacity ? i + 1 : RESPONSIVE_POOL_END;
+    slots[i].inUse = false;
+  }
+  freeHead = capacity > 0 ? 0 : RESPONSIVE_POOL_END;
+}
+
+ResponsiveAnalogRead* ResponsiveAnalogPool::allocate()
+{
+  if(freeHead == RESPONSIVE_POOL_END) {
+    failures++;
+    return NULL;
+  }
+
+  ResponsiveAnalogSlot& slot = slots[freeHead];
+  freeHead = slot.nextFree;
+  slot.nextFree = RESPONSIVE_POOL_END;
+  slot.inUse = true;
+  slot.channel = ResponsiveAnalogRead();
+
+  used++;
+  if(used > peak) {
+    peak = used;
+  }
+  return &slot.channel;
+}
+
+void ResponsiveAnalogPool::release(ResponsiveAnalogRead* channel)
+{
+  ResponsiveAnalogSlot* slot = slotOf(channel);
+  if(!channel || slot < slots || slot >= slots + capacity || !slot->inUse) {
+    return;
+  }
+
+  slot->inUse = false;
+  slot->nextFree = freeHead;
+  freeHead = slot - slots;
+  used--;
+}
+
+bool ResponsiveAnalogPool::setMap(ResponsiveAnalogRead* channel, const int* in, const int* out, uint8_t size)
+{
+  if(size > RESPONSIVE_POOL_MAP_POINTS) {
+    return false;
+  }
+
+  ResponsiveAnalogSlot* slot = slotOf(channel);
+  if(!slot->map.begin(slot->mapArena, sizeof(slot->mapArena), in, out, size)) {
+    return false;
+  }
+  channel->setMap(&slot->map);
+  return true;
+}
@@ -0,0 +1,100 @@
+/*
+ * ResponsiveAnalogPool.h
+ * Fixed capacity, heap free pool of ResponsiveAnalogRead channels and their mapping tables
+ *
+ * Copyright (c) 2016 Damien Clarke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef RESPONSIVE_ANALOG_POOL_H
+#define RESPONSIVE_ANALOG_POOL_H
+
+#include <Arduino.h>
+#include "ResponsiveAnalogRead.h"
+
+// both settings below change sizeof(ResponsiveAnalogSlot), so set them as global build flags (-D...) rather than
+// with a #define in the sketch, or the sketch and ResponsiveAnalogPool.cpp disagree about the slot layout
+
+// the largest mapping table a pooled channel can hold
+#ifndef RESPONSIVE_POOL_MAP_POINTS
+#define RESPONSIVE_POOL_MAP_POINTS 16
+#endif
+
+// define as 1 to give every slot room for its table's inverse too, so inverseMap() on a pooled channel is O(1).
+// Costs 513 bytes per slot, without it inverseMap() binary searches the table
+#ifndef RESPONSIVE_POOL_MAP_INVERSE
+#define RESPONSIVE_POOL_MAP_INVERSE 0
+#endif
+
+#if RESPONSIVE_POOL_MAP_INVERSE
+#define RESPONSIVE_POOL_MAP_ARENA RESPONSIVE_MAP_INVERSE_BYTES(RESPONSIVE_POOL_MAP_POINTS)
+#else
+#define RESPONSIVE_POOL_MAP_ARENA RESPONSIVE_MAP_BYTES(RESPONSIVE_POOL_MAP_POINTS)
+#endif
+
+#define RESPONSIVE_POOL_END 0xFF
+
+// one pooled channel with room for its mapping table, the caller declares a (usually global) array of these
+struct ResponsiveAnalogSlot
+{
+  ResponsiveAnalogRead channel; // must stay the first member, release() finds the slot from the channel's address
+  ResponsiveMap map;
+  uint8_t mapArena[RESPONSIVE_POOL_MAP_ARENA];
+  uint8_t nextFree;
+  bool inUse;
+};
+
+class ResponsiveAnalogPool
+{
+  public:
+
+    // slots - caller owned array, capacity up to 254 channels
+    void begin(ResponsiveAnalogSlot* slots, uint8_t capacity);
+
+    // take a channel from the free list, returns NULL when the pool is exhausted
+    // the channel is reset to a default constructed state, call begin() on it as usual
+    ResponsiveAnalogRead* allocate();
+    // give a channel back, it must have come from this pool
+    void release(ResponsiveAnalogRead* channel);
+
+    // copy a mapping table into the channel's slot and point the channel at it, returns false if the table
+    // has more than RESPONSIVE_POOL_MAP_POINTS points or doesn't fit a ResponsiveMap (see ResponsiveMap::begin())
+    bool setMap(ResponsiveAnalogRead* channel, const int* in, const int* out, uint8_t size);
+
+    inline uint8_t getCapacity() { return capacity; }
+    inline uint8_t getUsed() { return used; }
+    inline uint8_t getPeak() { return peak; } // the most channels ever allocated at once
+    inline uint16_t getFailures() { return failures; } // allocate() calls that found the pool empty
+    inline size_t getBytes() { return (size_t)capacity * sizeof(ResponsiveAnalogSlot); }
+
+  private:
+    ResponsiveAnalogSlot* slots = NULL;
+    uint8_t capacity = 0;
+    uint8_t freeHead = RESPONSIVE_POOL_END;
+    uint8_t used = 0;
+    uint8_t peak = 0;
+    uint16_t failures = 0;
+
+    inline ResponsiveAnalogSlot* slotOf(ResponsiveAnalogRead* channel) {
+      return reinterpret_cast<ResponsiveAnalogSlot*>(channel);
+    }
+};
+
+#endif
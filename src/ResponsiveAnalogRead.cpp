@@ -45,6 +45,9 @@ void ResponsiveAnalogRead::begin(int pin, bool sleepEnable, float snapMultiplier
 void ResponsiveAnalogRead::update()
 {
   rawValue = _useByte? doMapping(analogRead(pin)) : analogRead(pin);
+  if(_energy) {
+    _energy->conversion(_energyChannel);
+  }
   this->update(rawValue);
 }
 
@@ -52,9 +55,30 @@ void ResponsiveAnalogRead::update(int rawValueRead)
 {
   rawValue = rawValueRead;
   prevResponsiveValue = responsiveValue;
+#ifdef RESPONSIVE_ANALOG_READ_PREDICTION
+  float prevSmoothValue = smoothValue;
+#endif
+#ifdef RESPONSIVE_ANALOG_READ_STATS
+  bool wasSleeping = sleeping;
+#endif
   responsiveValue = getResponsiveValue(rawValue);
+  if(_energy) {
+    _energy->filterCycle(_energyChannel, sleepEnable && sleeping);
+  }
+#ifdef RESPONSIVE_ANALOG_READ_PREDICTION
+  if(predictionHorizonMS > 0.0) {
+    updatePrediction(prevSmoothValue);
+  } else {
+    predictedValue = responsiveValue;
+  }
+#endif
   responsiveValueHasChanged = responsiveValue != prevResponsiveValue;
-  if(_debug && responsiveValueHasChanged) {
+#ifdef RESPONSIVE_ANALOG_READ_STATS
+  recordStats(wasSleeping);
+#endif
+  if(_telemetry && responsiveValueHasChanged) {
+    _telemetry->push(_channel, rawValue, responsiveValue, RESPONSIVE_TELEMETRY_CHANGED | (sleeping ? RESPONSIVE_TELEMETRY_SLEEPING : 0));
+  } else if(_debug && responsiveValueHasChanged) {
     Serial.print(F("Change: raw=")); Serial.print(rawValue); Serial.print(F(" responsiveValue=")); Serial.println(responsiveValue);
   }
 }
@@ -125,6 +149,55 @@ int ResponsiveAnalogRead::getResponsiveValue(int newValue)
   return (int)smoothValue;
 }
 
+#ifdef RESPONSIVE_ANALOG_READ_STATS
+void ResponsiveAnalogRead::recordStats(bool wasSleeping)
+{
+  unsigned long now = millis();
+  stats.updates++;
+  if(wasSleeping && !sleeping) {
+    stats.wakes++;
+  }
+  if(responsiveValueHasChanged) {
+    stats.changes++;
+  }
+  // the time since the last update counts as awake if the channel was awake through it
+  if(!wasSleeping && stats.updates > 1) {
+    stats.awakeMS += now - statsLastMS;
+  }
+  statsLastMS = now;
+}
+#endif
+
+#ifdef RESPONSIVE_ANALOG_READ_PREDICTION
+void ResponsiveAnalogRead::updatePrediction(float prevSmoothValue)
+{
+  unsigned long now = micros();
+  unsigned long elapsedUS = now - lastUpdateUS;
+  lastUpdateUS = now;
+
+  // while sleeping the output is held, so there is no movement to extrapolate
+  // and noise must not leak through the prediction. sleeping is only kept up to date while sleep is enabled
+  if((sleepEnable && sleeping) || elapsedUS == 0) {
+    velocity = 0.0;
+    predictedValue = responsiveValue;
+    return;
+  }
+
+  // smooth the per-update velocity (units per millisecond) with a short exponential moving average,
+  // the smooth value is already filtered so this only needs to take the edge off uneven update timing
+  float instantVelocity = (smoothValue - prevSmoothValue) * 1000.0 / elapsedUS;
+  velocity += (instantVelocity - velocity) * 0.5;
+
+  float predicted = smoothValue + velocity * predictionHorizonMS;
+  if(predicted < 0.0) {
+    predicted = 0.0;
+  } else if(predicted > analogResolution - 1) {
+    predicted = analogResolution - 1;
+  }
+  predictedValue = (int)predicted;
+}
+#endif
+
 float ResponsiveAnalogRead::snapCurve(float x)
 {
   float y = 1.0 / (x + 1.0);
@@ -148,7 +221,8 @@ void ResponsiveAnalogRead::setSnapMultiplier(float newMultiplier)
 
 int ResponsiveAnalogRead::multiMap(int val)
 {
-  if(_debug) { Serial.printf(" val=%i",val); };
+  if(_table) return _table->lookup(val);
+  if(textDebug()) { Serial.printf(" val=%i",val); };
   // take care the value is within range
   // val = constrain(val, _in[0], _in[size-1]);
   if (val <= _in[0]) return _out[0];
@@ -166,26 +240,64 @@ int ResponsiveAnalogRead::multiMap(int val)
     }*/
     return _out[_mapSize-1];
   }
-  if(_debug) { Serial.print(" step2"); }
+  if(textDebug()) { Serial.print(" step2"); }
 
   // search right interval
   uint8_t pos = 1;  // _in[0] allready tested
   while(val > _in[pos]) pos++;
-  if(_debug) { Serial.printf(" for %i found in=%i #%i to out=%i\n",val, _in[pos], pos, _out[pos]); }
+  if(textDebug()) { Serial.printf(" for %i found in=%i #%i to out=%i\n",val, _in[pos], pos, _out[pos]); }
 
   // this will handle all exact "points" in the _in array
   if (val == _in[pos]) return _out[pos];
 
   // interpolate in the right segment for the rest
-  if(_debug) { Serial.print(" step"); }
+  if(textDebug()) { Serial.print(" step"); }
   return (val - _in[pos-1]) * (_out[pos] - _out[pos-1]) / (_in[pos] - _in[pos-1]) + _out[pos-1];
 }
 
+int ResponsiveAnalogRead::inverseMap(int value)
+{
+  // a ResponsiveMap keeps a precomputed inverse when given the room for it
+  if(_table) return _table->inverse(constrain(value, 0, 255));
+
+  // no table, undo setMinMax()'s linear map. map() truncates toward _toMin, so step away from _min
+  // by the rounded up distance to get the first raw value that reaches value, whichever way either range runs
+  if(!_map || !_in) {
+    if(_toMax == _toMin) return _min;
+    int low = _toMin < _toMax ? _toMin : _toMax;
+    int high = _toMin < _toMax ? _toMax : _toMin;
+    long steps = abs(constrain(value, low, high) - _toMin);
+    long span = abs(_max - _min);
+    long outSpan = high - low;
+    long offset = (steps * span + outSpan - 1) / outSpan;
+    return _max >= _min ? _min + offset : _min - offset;
+  }
+
+  // otherwise binary search the caller's arrays for the first point reaching value, out must not decrease
+  if (value <= _out[0]) return _in[0];
+  if (value > _out[_mapSize-1]) return _in[_mapSize-1];
+  uint8_t low = 1;
+  uint8_t high = _mapSize - 1;
+  while(low < high) {
+    uint8_t mid = (low + high) >> 1;
+    if(_out[mid] < value) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  if (value == _out[low]) return _in[low];
+  // multiMap() rounds down, so round up to land on the first raw value that reaches value
+  long outStep = _out[low] - _out[low-1];
+  return ((long)(value - _out[low-1]) * (_in[low] - _in[low-1]) + outStep - 1) / outStep + _in[low-1];
+}
+
 
 void ResponsiveAnalogRead::setMap(int* in, int* out, uint8_t size){
   _in=in; _out=out; _mapSize=size;
+  _table=NULL;
   _map=true;
-  if(_debug) {
+  if(textDebug()) {
     Serial.print("in=");
     for(int i=0;i<size;i++)
       Serial.printf("%i, ",_in[i]);
@@ -264,6 +376,26 @@ void ResponsiveAnalogRead::calibrate() {
   Serial.printf("%i};\n", 255);
   Serial.printf("int size=%i;\n", pos+1);
 
+  // the same table for flash saves over 1 KB of RAM on a long calibration. beginProgmem() needs strictly ascending
+  // inputs, so readings that noise pushed back, or past the maximum, are left out of that version
+  Serial.println(F("// or keep the table in flash, see ResponsiveMap.h:"));
+  int kept=0;
+  for(int table=0; table<2; table++){
+    Serial.print(table==0 ? F("// const uint16_t inFlash[] PROGMEM={") : F("// const uint8_t outFlash[] PROGMEM={"));
+    int last=-1;
+    kept=0;
+    for(int i=0; i<pos; i++){
+      if(buf[i]>last && buf[i]<max){
+        Serial.printf("%i,", table==0 ? buf[i] : i*add);
+        last=buf[i];
+        kept++;
+      }
+    }
+    Serial.printf("%i};\n", table==0 ? max : 255);
+  }
+  Serial.printf("// const uint8_t sizeFlash=%i;\n", kept+1);
+  Serial.println(F("// ResponsiveMap map; map.beginProgmem(inFlash, outFlash, sizeFlash); analog.setMap(&map);"));
+
 
   delay(3000);
 }
\ No newline at end of file
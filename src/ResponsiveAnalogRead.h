@@ -27,6 +27,26 @@
 #define RESPONSIVE_ANALOG_READ_H
 
 #include <Arduino.h>
+#include "ResponsiveTelemetry.h"
+#include "ResponsiveEnergy.h"
+#include "ResponsiveMap.h"
+
+// uncomment, or pass -DRESPONSIVE_ANALOG_READ_STATS in your build flags, to count per channel activity in update()
+//#define RESPONSIVE_ANALOG_READ_STATS
+
+// uncomment, or pass -DRESPONSIVE_ANALOG_READ_PREDICTION in your build flags, for getPredictedValue().
+// Off by default, so channels that don't use it carry neither its state nor its work in update()
+//#define RESPONSIVE_ANALOG_READ_PREDICTION
+
+#ifdef RESPONSIVE_ANALOG_READ_STATS
+struct ResponsiveAnalogStats
+{
+  uint32_t updates;  // update() calls
+  uint32_t wakes;    // times the channel came out of sleep
+  uint32_t changes;  // updates where the responsive value changed
+  uint32_t awakeMS;  // time spent awake
+};
+#endif
 
 class ResponsiveAnalogRead
 {
@@ -48,6 +68,7 @@ class ResponsiveAnalogRead
     
     inline int getValue() { return responsiveValue; } // get the responsive value from last update
     inline int getRawValue() { return rawValue; } // get the raw analogRead() value from last update
+    inline float getSmoothValue() { return smoothValue; } // get the unrounded filter output, for outputs with more resolution than the ADC
     inline bool hasChanged() { return responsiveValueHasChanged; } // returns true if the responsive value has changed during the last update
     inline bool isSleeping() { return sleeping; } // returns true if the algorithm is currently in sleeping mode
     void update(); // updates the value by performing an analogRead() and calculating a responsive value based off it
@@ -62,51 +83,94 @@ class ResponsiveAnalogRead
     inline void setActivityThreshold(float newThreshold) { activityThreshold = newThreshold; }
     // the amount of movement that must take place to register as activity and start moving the output value. Defaults to 4.0
     inline void setAnalogResolution(int resolution) { analogResolution = resolution; }
+    inline int getAnalogResolution() { return analogResolution; }
     // if your ADC is something other than 10bit (1024), set that here
 
+#ifdef RESPONSIVE_ANALOG_READ_PREDICTION
+    inline int getPredictedValue() { return predictedValue; } // get the responsive value extrapolated ahead by the prediction horizon
+    inline void setPredictionHorizon(float ms) { predictionHorizonMS = ms > 0.0 ? ms : 0.0; velocity = 0.0; }
+    // extrapolate getPredictedValue() this many milliseconds ahead along the current velocity to hide the easing lag,
+    // prediction stops while sleeping so idle jitter is never amplified. Defaults to 0 (off)
+#endif
+
+#ifdef RESPONSIVE_ANALOG_READ_STATS
+    inline const ResponsiveAnalogStats& getStats() { return stats; }
+    inline void resetStats() { stats = ResponsiveAnalogStats(); }
+#endif
+
     byte getByteValue();
     inline void setDebug(bool b) {_debug = b; }
+    inline void setTelemetry(ResponsiveTelemetry* telemetry, uint8_t channel) { _telemetry = telemetry; _channel = channel; }
+    // send a binary frame to the telemetry buffer on every change instead of printing debug text to Serial
+    inline void setEnergy(ResponsiveEnergy* energy, uint8_t channel) { _energy = energy; _energyChannel = channel; }
+    // count this channel's conversions and filter updates, to estimate what a sampling or sleep policy costs
     inline void enableMap(bool b) { _map = b; }
 
     void calibrate();
     int multiMap(int val);
+    // the first raw value that maps to value, e.g. a motorized fader setpoint. Inverts the table set with setMap(),
+    // or setMinMax()'s linear map when there is none. O(1) only with a ResponsiveMap that has its inverse table,
+    // the int arrays have no room for one and are binary searched instead
+    int inverseMap(int value);
 
-    void setMap(int* in, int* out, uint8_t size);
+    void setMap(int* in, int* out, uint8_t size); // the arrays are used in place and must outlive the object
+    inline void setMap(const ResponsiveMap* map) { _table = map; _map = map != NULL; }
+    // preferred: a ResponsiveMap owns a compact copy of the tables, see ResponsiveMap.h
     inline void setMinMax(int min, int max, int toMin, int toMax) { _min=min; _max=max; _toMin=toMin; _toMax=toMax; analogResolution=toMax+1; }
 
   private:
-    int pin;
+    int pin = 0;
     int analogResolution = 1024;
-    float snapMultiplier;
-    bool sleepEnable;
+    float snapMultiplier = 0.01;
+    bool sleepEnable = true;
     float activityThreshold = 4.0;
     bool edgeSnapEnable = true;
 
-    float smoothValue;
-    unsigned long lastActivityMS;
+    float smoothValue = 0.0;
+    unsigned long lastActivityMS = 0;
     float errorEMA = 0.0;
     bool sleeping = false;
 
-    int rawValue;
-    int responsiveValue;
-    int prevResponsiveValue;
-    bool responsiveValueHasChanged;
+    int rawValue = 0;
+    int responsiveValue = 0;
+    int prevResponsiveValue = 0;
+    bool responsiveValueHasChanged = false;
+
+#ifdef RESPONSIVE_ANALOG_READ_PREDICTION
+    float predictionHorizonMS = 0.0;
+    float velocity = 0.0;
+    unsigned long lastUpdateUS = 0;
+    int predictedValue = 0;
+    void updatePrediction(float prevSmoothValue);
+#endif
+
+#ifdef RESPONSIVE_ANALOG_READ_STATS
+    ResponsiveAnalogStats stats = ResponsiveAnalogStats();
+    unsigned long statsLastMS = 0;
+    void recordStats(bool wasSleeping);
+#endif
 
     int getResponsiveValue(int newValue);
     float snapCurve(float x);
 
     int doMapping(int val);
 
-    int _min;
-    int _max;
+    int _min=0;
+    int _max=1023;
     int _toMin=0;
     int _toMax=100;
-    bool _map;
-    bool _useByte;
-    bool _debug;
-    int* _in;
-    int* _out;
-    uint8_t _mapSize;
+    bool _map=false;
+    bool _useByte=false;
+    bool _debug = false;
+    ResponsiveTelemetry* _telemetry = NULL;
+    uint8_t _channel = 0;
+    ResponsiveEnergy* _energy = NULL;
+    uint8_t _energyChannel = 0;
+    inline bool textDebug() { return _debug && !_telemetry; }
+    int* _in=NULL;
+    int* _out=NULL;
+    const ResponsiveMap* _table = NULL;
+    uint8_t _mapSize=0;
 };
 
 #endif
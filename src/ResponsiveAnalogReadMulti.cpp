@@ -0,0 +1,114 @@
+/*
+ * ResponsiveAnalogReadMulti.cpp
+ * Several ResponsiveAnalogRead parameter sets run side by side over one input
+ *
+ * Copyright (c) 2016 Damien Clarke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <Arduino.h>
+#include "ResponsiveAnalogReadMulti.h"
+
+void ResponsiveAnalogReadMulti::begin(int pin, uint8_t lanes){
+    pinMode(pin, INPUT );
+    digitalWrite(pin, LOW );
+
+    this->pin = pin;
+    this->lanes = lanes < RESPONSIVE_MULTI_LANES ? lanes : RESPONSIVE_MULTI_LANES;
+    for(uint8_t i = 0; i < RESPONSIVE_MULTI_LANES; i++) {
+      snapMultiplier[i] = 0.01;
+      activityThreshold[i] = 4.0;
+      sleepEnable[i] = 1;
+      smoothValue[i] = 0.0;
+      errorEMA[i] = 0.0;
+      sleeping[i] = 0;
+      responsiveValue[i] = 0;
+    }
+    changedMask = 0;
+}
+
+void ResponsiveAnalogReadMulti::setLane(uint8_t lane, bool sleepEnable, float snapMultiplier, float activityThreshold)
+{
+  if(lane >= RESPONSIVE_MULTI_LANES) {
+    return;
+  }
+  this->sleepEnable[lane] = sleepEnable;
+  this->snapMultiplier[lane] = constrain(snapMultiplier, 0.0, 1.0);
+  this->activityThreshold[lane] = activityThreshold;
+}
+
+void ResponsiveAnalogReadMulti::update()
+{
+  update(analogRead(pin));
+}
+
+void ResponsiveAnalogReadMulti::update(int rawValueRead)
+{
+  rawValue = rawValueRead;
+
+  // each step below is ResponsiveAnalogRead::getResponsiveValue() with its branches turned into selects,
+  // see there for what they do. The arithmetic is kept identical so the lanes match single objects exactly.
+  // All RESPONSIVE_MULTI_LANES lanes run (unused ones are harmless) so the trip count is a constant
+  ResponsiveLaneFlag changed[RESPONSIVE_MULTI_LANES];
+  for(uint8_t i = 0; i < RESPONSIVE_MULTI_LANES; i++) {
+    float threshold = activityThreshold[i];
+    ResponsiveLaneFlag sleepOn = sleepEnable[i];
+
+    // edge snap, as arithmetic on 0/1 flags
+    int snapEdges = sleepOn & edgeSnapEnable;
+    int lowEdge = (rawValue * 2) - threshold;
+    int highEdge = (rawValue * 2) - analogResolution + threshold;
+    int useLow = snapEdges & (rawValue < threshold);
+    int useHigh = snapEdges & !useLow & (rawValue > analogResolution - threshold);
+    int newValue = rawValue + useLow * (lowEdge - rawValue) + useHigh * (highEdge - rawValue);
+
+    float smooth = smoothValue[i];
+    float error = errorEMA[i];
+    // ResponsiveAnalogRead keeps this as unsigned int, int holds the same value for any reading
+    // and converts to and from float in SIMD registers, where unsigned needs branches
+    int diff = fabs(newValue - smooth);
+    error += ((newValue - smooth) - error) * 0.4;
+    errorEMA[i] = error;
+
+    ResponsiveLaneFlag asleep = (sleepOn & (fabs(error) < threshold)) | (!sleepOn & (sleeping[i] != 0));
+    sleeping[i] = asleep;
+
+    // snap curve
+    float snap = 1.0 / (diff * snapMultiplier[i] + 1.0);
+    snap = (1.0 - snap) * 2.0;
+    snap = snap > 1.0 ? 1.0 : snap;
+
+    float moved = smooth + (newValue - smooth) * snap;
+    moved = moved < 0.0 ? 0.0 : moved;
+    moved = moved > analogResolution - 1 ? analogResolution - 1 : moved;
+    smooth = (sleepOn & asleep) ? smooth : moved;
+    smoothValue[i] = smooth;
+
+    int value = (int)smooth;
+    changed[i] = value != responsiveValue[i];
+    responsiveValue[i] = value;
+  }
+
+  uint16_t mask = 0;
+  for(uint8_t i = 0; i < lanes; i++) {
+    mask |= (uint16_t)changed[i] << i;
+  }
+  changedMask = mask;
+}
@@ -0,0 +1,96 @@
+/*
+ * ResponsiveAnalogReadMulti.h
+ * Several ResponsiveAnalogRead parameter sets run side by side over one input
+ *
+ * Copyright (c) 2016 Damien Clarke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef RESPONSIVE_ANALOG_READ_MULTI_H
+#define RESPONSIVE_ANALOG_READ_MULTI_H
+
+#include <Arduino.h>
+
+// how many parameter sets (lanes) one object can run, at most 16
+#ifndef RESPONSIVE_MULTI_LANES
+#define RESPONSIVE_MULTI_LANES 4
+#endif
+
+// per lane flags are as wide as the float state on 32 bit targets, so the compiler can load every lane array
+// into vectors of the same lane count. 8 bit boards have no SIMD and keep them as bytes
+#ifdef __AVR__
+typedef uint8_t ResponsiveLaneFlag;
+#else
+typedef int32_t ResponsiveLaneFlag;
+#endif
+
+// One input, several outputs: e.g. a fast, twitchy value for a meter and a heavily smoothed one for a parameter.
+// The pin is read once per update and each lane runs the ResponsiveAnalogRead algorithm with its own settings,
+// giving exactly the values separate ResponsiveAnalogRead objects would. Lane state is kept in parallel arrays
+// and every lane runs the same branch free steps, so compilers can put the lanes in SIMD registers.
+class ResponsiveAnalogReadMulti
+{
+  public:
+
+    ResponsiveAnalogReadMulti(){};  //default constructor must be followed by call to begin function
+    ResponsiveAnalogReadMulti(int pin, uint8_t lanes){
+        begin(pin, lanes);
+    };
+
+    // lanes start with sleep enabled, snapMultiplier 0.01 and activityThreshold 4.0, like ResponsiveAnalogRead
+    void begin(int pin, uint8_t lanes);
+    void setLane(uint8_t lane, bool sleepEnable, float snapMultiplier, float activityThreshold = 4.0);
+
+    void update(); // reads the pin once and updates every lane
+    void update(int rawValueRead);
+
+    inline uint8_t getLanes() { return lanes; }
+    inline int getRawValue() { return rawValue; }
+    inline int getValue(uint8_t lane) { return responsiveValue[lane]; }
+    inline float getSmoothValue(uint8_t lane) { return smoothValue[lane]; }
+    inline bool hasChanged(uint8_t lane) { return (changedMask >> lane) & 1; }
+    inline bool isSleeping(uint8_t lane) { return sleeping[lane] != 0; }
+    inline uint16_t getChangedMask() { return changedMask; } // bit n set when lane n changed during the last update
+
+    inline void enableEdgeSnap() { edgeSnapEnable = true; }
+    inline void disableEdgeSnap() { edgeSnapEnable = false; }
+    inline void setAnalogResolution(int resolution) { analogResolution = resolution; }
+
+  private:
+    int pin = 0;
+    uint8_t lanes = 0;
+    int analogResolution = 1024;
+    bool edgeSnapEnable = true;
+    int rawValue = 0;
+    uint16_t changedMask = 0;
+
+    // per lane settings
+    float snapMultiplier[RESPONSIVE_MULTI_LANES];
+    float activityThreshold[RESPONSIVE_MULTI_LANES];
+    ResponsiveLaneFlag sleepEnable[RESPONSIVE_MULTI_LANES];
+
+    // per lane state
+    float smoothValue[RESPONSIVE_MULTI_LANES];
+    float errorEMA[RESPONSIVE_MULTI_LANES];
+    ResponsiveLaneFlag sleeping[RESPONSIVE_MULTI_LANES];
+    int responsiveValue[RESPONSIVE_MULTI_LANES];
+};
+
+#endif
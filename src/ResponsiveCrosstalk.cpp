@@ -0,0 +1,139 @@
+/*
+ * ResponsiveCrosstalk.cpp
+ * Banded crosstalk correction for multiplexed ResponsiveAnalogBank frames
+ *
+ * Copyright (c) 2016 Damien Clarke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <Arduino.h>
+#include "ResponsiveCrosstalk.h"
+
+// neighbour movements smaller than this are too close to the noise floor to learn from
+#define CROSSTALK_MIN_STEP 16
+// a frame only teaches channel i about a neighbour when the neighbour moved this many times more than i did,
+// which keeps frames where i itself is being turned out of the fit
+#define CROSSTALK_DOMINANCE 8
+
+void ResponsiveCrosstalk::begin(int16_t* storage, uint8_t count)
+{
+  this->count = count;
+  prevCoeffs = storage;
+  nextCoeffs = storage + count;
+  lastFrame = storage + 2 * count;
+  delta = storage + 3 * count;
+  primed = false;
+  sums = NULL;
+
+  for(uint16_t i = 0; i < RESPONSIVE_CROSSTALK_STORAGE(count); i++) {
+    storage[i] = 0;
+  }
+}
+
+void ResponsiveCrosstalk::setCoefficients(uint8_t channel, float fromPrevious, float fromNext)
+{
+  fromPrevious = constrain(fromPrevious, -0.5, 0.5);
+  fromNext = constrain(fromNext, -0.5, 0.5);
+  prevCoeffs[channel] = channel > 0 ? (int16_t)(fromPrevious * 32768.0) : 0;
+  nextCoeffs[channel] = channel + 1 < count ? (int16_t)(fromNext * 32768.0) : 0;
+}
+
+bool ResponsiveCrosstalk::updateDelta(const int* frame)
+{
+  // straight element-wise pass over plain arrays so it vectorises
+  for(uint8_t i = 0; i < count; i++) {
+    delta[i] = (int16_t)(frame[i] - lastFrame[i]);
+    lastFrame[i] = (int16_t)frame[i];
+  }
+  // the first frame has nothing to compare against
+  bool wasPrimed = primed;
+  primed = true;
+  return wasPrimed;
+}
+
+void ResponsiveCrosstalk::apply(int* frame)
+{
+  if(count < 2 || !updateDelta(frame)) {
+    return;
+  }
+
+  // the deltas are read only here and every entry only writes itself, so the interior loop has no
+  // carried dependency and costs two multiply-adds per channel. A pot resting at 0 next to one that jumps
+  // would be corrected below zero, which later stages would read as a huge value, so the result is clamped
+  uint8_t last = count - 1;
+  int corrected = frame[0] - (((int32_t)nextCoeffs[0] * delta[1] + 0x4000) >> 15);
+  frame[0] = corrected < 0 ? 0 : corrected;
+  for(uint8_t i = 1; i < last; i++) {
+    corrected = frame[i] - (((int32_t)prevCoeffs[i] * delta[i - 1] + (int32_t)nextCoeffs[i] * delta[i + 1] + 0x4000) >> 15);
+    frame[i] = corrected < 0 ? 0 : corrected;
+  }
+  corrected = frame[last] - (((int32_t)prevCoeffs[last] * delta[last - 1] + 0x4000) >> 15);
+  frame[last] = corrected < 0 ? 0 : corrected;
+}
+
+void ResponsiveCrosstalk::beginCalibration(float* sums)
+{
+  this->sums = sums;
+  for(uint16_t i = 0; i < RESPONSIVE_CROSSTALK_CALIBRATION_STORAGE(count); i++) {
+    sums[i] = 0.0;
+  }
+  primed = false;
+}
+
+void ResponsiveCrosstalk::calibrate(const int* frame)
+{
+  if(!sums || !updateDelta(frame)) {
+    return;
+  }
+
+  // least squares fit of delta[i] = k * delta[neighbour], per channel and side:
+  // sums holds sum(xy) and sum(xx) for the previous neighbour, then the same for the next one
+  for(uint8_t i = 0; i < count; i++) {
+    if(i > 0) {
+      accumulate(sums + 4 * i, i, i - 1);
+    }
+    if(i + 1 < count) {
+      accumulate(sums + 4 * i + 2, i, i + 1);
+    }
+  }
+}
+
+void ResponsiveCrosstalk::accumulate(float* sums, uint8_t channel, int neighbour)
+{
+  int moved = abs(delta[neighbour]);
+  if(moved < CROSSTALK_MIN_STEP || moved < CROSSTALK_DOMINANCE * abs(delta[channel])) {
+    return;
+  }
+  sums[0] += (float)delta[channel] * delta[neighbour];
+  sums[1] += (float)delta[neighbour] * delta[neighbour];
+}
+
+void ResponsiveCrosstalk::endCalibration()
+{
+  if(!sums) {
+    return;
+  }
+  for(uint8_t i = 0; i < count; i++) {
+    float* s = sums + 4 * i;
+    setCoefficients(i, s[1] > 0.0 ? s[0] / s[1] : 0.0, s[3] > 0.0 ? s[2] / s[3] : 0.0);
+  }
+  sums = NULL;
+  primed = false;
+}
@@ -0,0 +1,75 @@
+/*
+ * ResponsiveCrosstalk.h
+ * Banded crosstalk correction for multiplexed ResponsiveAnalogBank frames
+ *
+ * Copyright (c) 2016 Damien Clarke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef RESPONSIVE_CROSSTALK_H
+#define RESPONSIVE_CROSSTALK_H
+
+#include <Arduino.h>
+
+// number of int16_t the caller must provide to begin() for a given channel count
+#define RESPONSIVE_CROSSTALK_STORAGE(count) (4 * (count))
+// number of floats the caller must provide to beginCalibration() for a given channel count
+#define RESPONSIVE_CROSSTALK_CALIBRATION_STORAGE(count) (4 * (count))
+
+// A multiplexer that hasn't fully settled leaks part of the previous channel's movement into the next reading.
+// This models each reading as its true value plus a fraction of the change of its scan neighbours, i.e. a
+// tridiagonal matrix applied to the per-frame deltas, and subtracts that again before the frame is filtered.
+// Channels are assumed to be stored in scan order.
+class ResponsiveCrosstalk
+{
+  public:
+
+    // storage - caller owned array of RESPONSIVE_CROSSTALK_STORAGE(count) int16_t, all coefficients start at zero
+    void begin(int16_t* storage, uint8_t count);
+
+    // coefficient is the fraction of a neighbour's change that leaks into channel, -0.5 to 0.5
+    void setCoefficients(uint8_t channel, float fromPrevious, float fromNext);
+    inline float getPreviousCoefficient(uint8_t channel) { return prevCoeffs[channel] / 32768.0; }
+    inline float getNextCoefficient(uint8_t channel) { return nextCoeffs[channel] / 32768.0; }
+
+    // correct one frame of raw readings in place
+    void apply(int* frame);
+
+    // learn the coefficients from live frames: call beginCalibration(), then feed frames to calibrate()
+    // while turning ONE knob at a time quickly across its range, then call endCalibration()
+    // sums - caller owned array of RESPONSIVE_CROSSTALK_CALIBRATION_STORAGE(count) floats, only needed until endCalibration()
+    void beginCalibration(float* sums);
+    void calibrate(const int* frame);
+    void endCalibration();
+
+  private:
+    uint8_t count = 0;
+    bool primed = false;
+    int16_t* prevCoeffs = NULL; // Q15, leak from channel - 1
+    int16_t* nextCoeffs = NULL; // Q15, leak from channel + 1
+    int16_t* lastFrame = NULL;
+    int16_t* delta = NULL;
+    float* sums = NULL;
+
+    bool updateDelta(const int* frame);
+    void accumulate(float* sums, uint8_t channel, int neighbour);
+};
+
+#endif
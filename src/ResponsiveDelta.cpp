@@ -0,0 +1,55 @@
+/*
+ * ResponsiveDelta.cpp
+ * Relative (encoder style) output from a ResponsiveAnalogRead
+ *
+ * Copyright (c) 2016 Damien Clarke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <Arduino.h>
+#include "ResponsiveDelta.h"
+
+void ResponsiveDelta::begin(float stepSize)
+{
+  setStepSize(stepSize);
+  delta = 0;
+  started = false;
+}
+
+int ResponsiveDelta::update(ResponsiveAnalogRead& input)
+{
+  return update(input.getSmoothValue());
+}
+
+int ResponsiveDelta::update(float position)
+{
+  if(!started) {
+    reference = position;
+    started = true;
+    delta = 0;
+    return 0;
+  }
+
+  // truncating towards zero keeps the remainder in (-stepSize, stepSize), which is what gives a full step of
+  // hysteresis: after a step up the reference sits on the boundary that was just crossed
+  delta = (int)((position - reference) / stepSize);
+  reference += delta * stepSize;
+  return delta;
+}
@@ -0,0 +1,62 @@
+/*
+ * ResponsiveDelta.h
+ * Relative (encoder style) output from a ResponsiveAnalogRead
+ *
+ * Copyright (c) 2016 Damien Clarke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef RESPONSIVE_DELTA_H
+#define RESPONSIVE_DELTA_H
+
+#include <Arduino.h>
+#include "ResponsiveAnalogRead.h"
+
+// Turns the absolute position of a filtered input into signed steps, like an endless encoder.
+// Movement is accumulated from the unrounded filter output and only whole steps are handed out, the
+// remainder carries over to the next update. Once a step is handed out the input has to move a full
+// step back before a negative one follows, so noise sitting on a step boundary never sends anything.
+class ResponsiveDelta
+{
+  public:
+
+    // stepSize - how far the filtered value has to move, in ADC units, for one step
+    void begin(float stepSize);
+    inline void setStepSize(float stepSize) { this->stepSize = stepSize > 0.0 ? stepSize : 1.0; }
+
+    // call after input.update(), returns the signed number of steps since the last call, 0 while nothing is to be sent
+    int update(ResponsiveAnalogRead& input);
+    // the same for any other source of unrounded positions
+    int update(float position);
+
+    inline int getDelta() { return delta; }
+    inline bool hasChanged() { return delta != 0; }
+
+    // take the next position as the new reference without sending anything, e.g. after switching pages
+    inline void resync() { started = false; }
+
+  private:
+    float stepSize = 1.0;
+    float reference = 0.0;
+    int delta = 0;
+    bool started = false;
+};
+
+#endif
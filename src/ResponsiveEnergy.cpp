@@ -0,0 +1,74 @@
+/*
+ * ResponsiveEnergy.cpp
+ * Energy estimates for sampling and sleep policies
+ *
+ * Copyright (c) 2016 Damien Clarke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <Arduino.h>
+#include "ResponsiveEnergy.h"
+
+void ResponsiveEnergy::begin(ResponsiveEnergyCounters* counters, uint8_t count)
+{
+  this->counters = counters;
+  this->count = count;
+  reset();
+}
+
+void ResponsiveEnergy::reset()
+{
+  for(uint8_t i = 0; i < count; i++) {
+    counters[i] = ResponsiveEnergyCounters();
+  }
+  startMS = millis();
+}
+
+float ResponsiveEnergy::getActiveUS(uint8_t channel, const ResponsiveEnergyModel& model)
+{
+  const ResponsiveEnergyCounters& c = counters[channel];
+  return c.conversions * model.conversionUS + c.awakeCycles * model.awakeFilterUS + c.sleepingCycles * model.sleepingFilterUS;
+}
+
+float ResponsiveEnergy::getChannelUJ(uint8_t channel, const ResponsiveEnergyModel& model)
+{
+  // µW x µs = pJ
+  float adcUS = counters[channel].conversions * model.conversionUS;
+  return (getActiveUS(channel, model) * model.activeUW + adcUS * model.adcUW) / 1e6;
+}
+
+float ResponsiveEnergy::estimateUJPerSecond(const ResponsiveEnergyModel& model, float seconds)
+{
+  if(seconds <= 0.0) {
+    return 0.0;
+  }
+  float activeUS = 0.0;
+  float workUJ = 0.0;
+  for(uint8_t i = 0; i < count; i++) {
+    activeUS += getActiveUS(i, model);
+    workUJ += getChannelUJ(i, model);
+  }
+  // a policy that keeps the CPU busy all the time can't idle, whatever the counts say
+  float idleUS = seconds * 1e6 - activeUS;
+  if(idleUS < 0.0) {
+    idleUS = 0.0;
+  }
+  return (workUJ + idleUS * model.idleUW / 1e6) / seconds;
+}
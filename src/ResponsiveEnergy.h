@@ -0,0 +1,95 @@
+/*
+ * ResponsiveEnergy.h
+ * Energy estimates for sampling and sleep policies
+ *
+ * Copyright (c) 2016 Damien Clarke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef RESPONSIVE_ENERGY_H
+#define RESPONSIVE_ENERGY_H
+
+#include <Arduino.h>
+
+// what a board draws, and how long the work takes on it. Power in microwatts, time in microseconds
+struct ResponsiveEnergyModel
+{
+  float activeUW;         // CPU running
+  float idleUW;           // CPU asleep between scans, in whatever sleep mode the sketch uses
+  float adcUW;            // drawn by the ADC on top of activeUW while it converts
+  float conversionUS;     // one analogRead()
+  float awakeFilterUS;    // one ResponsiveAnalogRead update while awake
+  float sleepingFilterUS; // one update while asleep, which stops before the snap curve
+};
+
+// ballpark figures from the datasheets and the Arduino cores' analogRead(), measure your own board for real numbers:
+// ATmega328P at 16MHz and 5V, idle sleep mode with timer 0 running, software floating point
+#define RESPONSIVE_ENERGY_AVR_16MHZ { 47500.0, 15000.0, 1500.0, 112.0, 80.0, 35.0 }
+// SAMD21 at 48MHz and 3.3V, IDLE sleep, the core's default (slow) analogRead()
+#define RESPONSIVE_ENERGY_SAMD21 { 23000.0, 5000.0, 1000.0, 425.0, 25.0, 10.0 }
+
+struct ResponsiveEnergyCounters
+{
+  uint32_t conversions;    // ADC conversions
+  uint32_t awakeCycles;    // filter updates that ran the snap curve
+  uint32_t sleepingCycles; // filter updates that stopped early because the channel slept
+  uint32_t skipped;        // scans where the policy left the channel alone
+};
+
+// Counts the work each channel costs, to compare sampling and sleep policies on the same recording.
+// ResponsiveAnalogRead::setEnergy() counts filter updates, and a conversion for every update() that reads the pin.
+// Code that reads the ADC itself (a multiplexer scan, a bank) calls conversion(), and a policy that leaves a
+// channel out of a scan calls skip(), which costs nothing but shows how often it happened.
+class ResponsiveEnergy
+{
+  public:
+
+    // counters - caller owned array of count entries
+    void begin(ResponsiveEnergyCounters* counters, uint8_t count);
+    void reset();
+
+    inline void conversion(uint8_t channel) { counters[channel].conversions++; }
+    inline void filterCycle(uint8_t channel, bool sleeping) {
+      if(sleeping) counters[channel].sleepingCycles++; else counters[channel].awakeCycles++;
+    }
+    inline void skip(uint8_t channel) { counters[channel].skipped++; }
+
+    inline uint8_t getCount() { return count; }
+    inline const ResponsiveEnergyCounters& getCounters(uint8_t channel) { return counters[channel]; }
+
+    // microseconds of CPU time and microjoules one channel's counted work took
+    float getActiveUS(uint8_t channel, const ResponsiveEnergyModel& model);
+    float getChannelUJ(uint8_t channel, const ResponsiveEnergyModel& model);
+
+    // average draw of the whole system in microjoules per second (i.e. microwatts) over seconds of counting:
+    // every channel's work at active power, the rest of the time at idle power
+    float estimateUJPerSecond(const ResponsiveEnergyModel& model, float seconds);
+    // the same, over the time since begin() or reset()
+    inline float estimateUJPerSecond(const ResponsiveEnergyModel& model) {
+      return estimateUJPerSecond(model, (millis() - startMS) / 1000.0);
+    }
+
+  private:
+    ResponsiveEnergyCounters* counters = NULL;
+    uint8_t count = 0;
+    unsigned long startMS = 0;
+};
+
+#endif
@@ -0,0 +1,242 @@
+/*
+ * ResponsiveFrame.cpp
+ * Delta frames carrying a ResponsiveAnalogBank over a serial link
+ *
+ * Copyright (c) 2016 Damien Clarke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <Arduino.h>
+#include "ResponsiveFrame.h"
+#include "ResponsiveTelemetry.h"
+
+void ResponsiveFrameEncoder::begin(ResponsiveAnalogBank& bank, uint8_t* pending, uint8_t keyInterval, uint8_t keySlice)
+{
+  this->bank = &bank;
+  this->pending = pending;
+  this->keyInterval = keyInterval;
+  this->keySlice = keySlice == 0 ? 1 : (keySlice > 124 ? 124 : keySlice);
+  for(uint8_t i = 0; i < RESPONSIVE_FRAME_STORAGE(bank.getCount()); i++) {
+    pending[i] = 0;
+  }
+  sinceKey = 0;
+  nextKey = 0;
+  sequence = 0;
+  // the receiver knows nothing yet, start with a key frame
+  keyRequested = true;
+}
+
+uint16_t ResponsiveFrameEncoder::encode(uint8_t* out, uint16_t capacity)
+{
+  // collect this update's changes on top of anything that didn't fit into earlier frames
+  if(bank->hasChanged()) {
+    for(uint8_t i = 0; i < bank->getCount(); i++) {
+      if(bank->hasChanged(i)) {
+        pending[i >> 3] |= 1 << (i & 7);
+      }
+    }
+  }
+
+  uint16_t length = 0;
+  if(keyInterval && ++sinceKey >= keyInterval) {
+    keyRequested = true;
+  }
+  if(keyRequested) {
+    length = encodeKey(out, capacity);
+    if(length) {
+      keyRequested = false;
+      sinceKey = 0;
+    }
+  }
+  return length + encodeDelta(out + length, capacity - length);
+}
+
+static inline uint16_t frameValue(int value)
+{
+  return value < 0 ? 0 : (value > 0xFFFF ? 0xFFFF : value);
+}
+
+uint8_t ResponsiveFrameEncoder::encodeKey(uint8_t* out, uint16_t capacity)
+{
+  uint8_t count = bank->getCount();
+  uint16_t room = capacity < RESPONSIVE_FRAME_MAX_BYTES ? capacity : RESPONSIVE_FRAME_MAX_BYTES;
+  if(count == 0 || room < 8) {
+    return 0;
+  }
+  if(nextKey >= count) {
+    nextKey = 0;
+  }
+
+  uint8_t entries = count - nextKey < keySlice ? count - nextKey : keySlice;
+  if(6 + 2 * entries > room) {
+    entries = (room - 6) / 2;
+  }
+
+  out[4] = nextKey;
+  for(uint8_t k = 0; k < entries; k++) {
+    uint8_t index = nextKey + k;
+    uint16_t value = frameValue(bank->getValue(index));
+    out[5 + 2 * k] = (uint8_t)value;
+    out[6 + 2 * k] = (uint8_t)(value >> 8);
+    // the slice carries the current value, no need to send it again as a delta
+    pending[index >> 3] &= ~(1 << (index & 7));
+  }
+  nextKey += entries;
+  return finish(out, RESPONSIVE_FRAME_KEY, entries, 5 + 2 * entries);
+}
+
+uint8_t ResponsiveFrameEncoder::encodeDelta(uint8_t* out, uint16_t capacity)
+{
+  uint16_t room = capacity < RESPONSIVE_FRAME_MAX_BYTES ? capacity : RESPONSIVE_FRAME_MAX_BYTES;
+  uint8_t entries = 0;
+  uint8_t length = 4;
+
+  for(uint8_t byte = 0; byte < RESPONSIVE_FRAME_STORAGE(bank->getCount()); byte++) {
+    // most updates change nothing or a channel or two, skip eight quiet channels at a time
+    while(pending[byte]) {
+      if(length + 3 + 1 > room) {
+        return entries ? finish(out, RESPONSIVE_FRAME_DELTA, entries, length) : 0;
+      }
+      uint8_t bit = 0;
+      while(!(pending[byte] & (1 << bit))) {
+        bit++;
+      }
+      pending[byte] &= ~(1 << bit);
+
+      uint8_t index = (byte << 3) | bit;
+      uint16_t value = frameValue(bank->getValue(index));
+      out[length++] = index;
+      out[length++] = (uint8_t)value;
+      out[length++] = (uint8_t)(value >> 8);
+      entries++;
+    }
+  }
+  return entries ? finish(out, RESPONSIVE_FRAME_DELTA, entries, length) : 0;
+}
+
+// fill in the header and CRC around a payload already written from out + 4, returns the whole frame length
+uint8_t ResponsiveFrameEncoder::finish(uint8_t* out, uint8_t type, uint8_t entries, uint8_t length)
+{
+  out[0] = RESPONSIVE_FRAME_SYNC;
+  out[1] = sequence++;
+  out[2] = type;
+  out[3] = entries;
+  out[length] = responsiveCrc8(out + 1, length - 1);
+  return length + 1;
+}
+
+void ResponsiveFrameDecoder::begin(uint16_t* values, uint8_t count)
+{
+  this->values = values;
+  this->count = count;
+  for(uint8_t i = 0; i < count; i++) {
+    values[i] = 0;
+  }
+  started = false;
+  covered = 0;
+  synced = false;
+  lost = 0;
+  errors = 0;
+}
+
+uint16_t ResponsiveFrameDecoder::decode(const uint8_t* data, uint16_t length)
+{
+  uint16_t i = 0;
+  while(i < length) {
+    if(data[i] != RESPONSIVE_FRAME_SYNC) {
+      i++;
+      continue;
+    }
+    uint16_t left = length - i;
+    if(left < 4) {
+      break;
+    }
+
+    const uint8_t* frame = data + i;
+    uint16_t size;
+    if(frame[2] == RESPONSIVE_FRAME_DELTA) {
+      size = 5 + 3 * frame[3];
+    } else if(frame[2] == RESPONSIVE_FRAME_KEY) {
+      size = 6 + 2 * frame[3];
+    } else {
+      size = 0;
+    }
+
+    // a sync byte that doesn't start a sane frame is noise or part of a damaged frame, look for the next one
+    if(size == 0 || size > RESPONSIVE_FRAME_MAX_BYTES) {
+      errors++;
+      i++;
+      continue;
+    }
+    if(left < size) {
+      break;
+    }
+    if(responsiveCrc8(frame + 1, size - 2) != frame[size - 1]) {
+      errors++;
+      i++;
+      continue;
+    }
+
+    apply(frame);
+    i += size;
+  }
+  return i;
+}
+
+void ResponsiveFrameDecoder::apply(const uint8_t* frame)
+{
+  uint8_t sequence = frame[1];
+  if(started && sequence != expected) {
+    // deltas in the missing frames are gone, only a full round of key frame slices makes every value trustworthy again
+    lost += (uint8_t)(sequence - expected);
+    covered = 0;
+    synced = false;
+  }
+  started = true;
+  expected = sequence + 1;
+
+  uint8_t entries = frame[3];
+  if(frame[2] == RESPONSIVE_FRAME_DELTA) {
+    for(uint8_t k = 0; k < entries; k++) {
+      const uint8_t* entry = frame + 4 + 3 * k;
+      set(entry[0], entry[1] | (entry[2] << 8));
+    }
+  } else {
+    uint8_t first = frame[4];
+    for(uint8_t k = 0; k < entries; k++) {
+      set(first + k, frame[5 + 2 * k] | (frame[6 + 2 * k] << 8));
+    }
+    covered += entries;
+    if(covered >= count) {
+      synced = true;
+    }
+  }
+}
+
+void ResponsiveFrameDecoder::set(uint8_t index, uint16_t value)
+{
+  if(index >= count || values[index] == value) {
+    return;
+  }
+  values[index] = value;
+  if(handler) {
+    handler(index, value);
+  }
+}
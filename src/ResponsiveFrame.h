@@ -0,0 +1,119 @@
+/*
+ * ResponsiveFrame.h
+ * Delta frames carrying a ResponsiveAnalogBank over a serial link
+ *
+ * Copyright (c) 2016 Damien Clarke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef RESPONSIVE_FRAME_H
+#define RESPONSIVE_FRAME_H
+
+#include <Arduino.h>
+#include "ResponsiveAnalogBank.h"
+
+// frame layout (all multi-byte fields little endian):
+//   0     sync byte 0xA6
+//   1     sequence number, one more than the previous frame
+//   2     type, RESPONSIVE_FRAME_DELTA or RESPONSIVE_FRAME_KEY
+//   3     entry count n
+//   delta frames: n x (uint8 channel index, uint16 value)
+//   key frames:   uint8 first channel index, then n x uint16 value for channels first to first + n - 1
+//   last  CRC-8 (poly 0x07, see responsiveCrc8()) over everything from the sequence number on
+// Deltas only carry channels that changed. Key frames walk through the bank a slice at a time, so a receiver
+// that lost a frame is back in step after one round of slices without the link ever carrying the whole bank at once
+#define RESPONSIVE_FRAME_SYNC 0xA6
+#define RESPONSIVE_FRAME_DELTA 0x01
+#define RESPONSIVE_FRAME_KEY 0x02
+#define RESPONSIVE_FRAME_MAX_BYTES 255
+
+// number of bytes the caller must provide to ResponsiveFrameEncoder::begin() for a given channel count
+#define RESPONSIVE_FRAME_STORAGE(count) (((count) + 7) / 8)
+
+class ResponsiveFrameEncoder
+{
+  public:
+
+    // pending - caller owned array of RESPONSIVE_FRAME_STORAGE(bank.getCount()) bytes
+    // keyInterval - updates between key frame slices, 0 for none
+    // keySlice - channels per key frame slice, at most 124
+    void begin(ResponsiveAnalogBank& bank, uint8_t* pending, uint8_t keyInterval = 8, uint8_t keySlice = 16);
+
+    // call once after every bank.update(). Writes the frames due into out, e.g. straight into a TX DMA buffer,
+    // and returns their total length: 0 when nothing changed and no key frame is due, otherwise a delta frame,
+    // a key frame slice or both back to back. out must hold capacity bytes, at most RESPONSIVE_FRAME_MAX_BYTES
+    // are used. Changes that don't fit are carried over to the next call
+    uint16_t encode(uint8_t* out, uint16_t capacity);
+
+    // send the next key frame slice with the next encode(), e.g. when the receiver reports a loss on a back channel
+    inline void requestKeyFrame() { keyRequested = true; }
+
+  private:
+    ResponsiveAnalogBank* bank = NULL;
+    uint8_t* pending = NULL;
+    uint8_t keyInterval = 8;
+    uint8_t keySlice = 16;
+    uint8_t sinceKey = 0;
+    uint8_t nextKey = 0;
+    bool keyRequested = false;
+    uint8_t sequence = 0;
+
+    uint8_t encodeKey(uint8_t* out, uint16_t capacity);
+    uint8_t encodeDelta(uint8_t* out, uint16_t capacity);
+    uint8_t finish(uint8_t* out, uint8_t type, uint8_t entries, uint8_t length);
+};
+
+class ResponsiveFrameDecoder
+{
+  public:
+
+    // values - caller owned array of count values, updated as frames arrive
+    void begin(uint16_t* values, uint8_t count);
+
+    // called for every value that a frame changed
+    inline void setHandler(void (*handler)(uint8_t index, uint16_t value)) { this->handler = handler; }
+
+    // apply every intact frame found in data, skipping noise and corrupted frames, and return the number of
+    // bytes used. An incomplete frame at the end is not used: keep those bytes and pass them again in front of
+    // the next ones, so a receive buffer must hold at least RESPONSIVE_FRAME_MAX_BYTES
+    uint16_t decode(const uint8_t* data, uint16_t length);
+
+    inline uint16_t getValue(uint8_t index) { return values[index]; }
+    inline uint16_t getLost() { return lost; } // frames missing from the sequence
+    inline uint16_t getErrors() { return errors; } // frames dropped for a bad CRC or layout
+    // false from begin() and after a loss until key frames have refreshed every channel
+    inline bool isSynced() { return synced; }
+
+  private:
+    uint16_t* values = NULL;
+    uint8_t count = 0;
+    void (*handler)(uint8_t index, uint16_t value) = NULL;
+    bool started = false;
+    uint8_t expected = 0;
+    uint16_t covered = 0;
+    bool synced = false;
+    uint16_t lost = 0;
+    uint16_t errors = 0;
+
+    void apply(const uint8_t* frame);
+    void set(uint8_t index, uint16_t value);
+};
+
+#endif
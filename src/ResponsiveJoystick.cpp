@@ -0,0 +1,156 @@
+/*
+ * ResponsiveJoystick.cpp
+ * Two axis ResponsiveAnalogRead filter with a radial dead zone and a shared sleep state
+ *
+ * Copyright (c) 2016 Damien Clarke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <Arduino.h>
+#include "ResponsiveJoystick.h"
+
+void ResponsiveJoystick::begin(int pinX, int pinY, bool sleepEnable, float snapMultiplier){
+    pinMode(pinX, INPUT );
+    digitalWrite(pinX, LOW );
+    pinMode(pinY, INPUT );
+    digitalWrite(pinY, LOW );
+
+    this->pinX = pinX;
+    this->pinY = pinY;
+    this->sleepEnable = sleepEnable;
+    setSnapMultiplier(snapMultiplier);
+    restartAtCenter();
+}
+
+void ResponsiveJoystick::setAnalogResolution(int resolution)
+{
+  analogResolution = resolution;
+  centerX = centerY = resolution / 2;
+  restartAtCenter();
+}
+
+void ResponsiveJoystick::setCenter(int x, int y)
+{
+  centerX = x;
+  centerY = y;
+  restartAtCenter();
+}
+
+void ResponsiveJoystick::restartAtCenter()
+{
+  // start from rest at the center, not from wherever the smoothing was in the old range
+  smoothX = rawX = responsiveX = centerX;
+  smoothY = rawY = responsiveY = centerY;
+  errorX = 0.0;
+  errorY = 0.0;
+  sleeping = false;
+  responsiveValueHasChanged = false;
+}
+
+void ResponsiveJoystick::update()
+{
+  update(analogRead(pinX), analogRead(pinY));
+}
+
+void ResponsiveJoystick::update(int rawXRead, int rawYRead)
+{
+  rawX = rawXRead;
+  rawY = rawYRead;
+  int prevX = responsiveX;
+  int prevY = responsiveY;
+
+  float x = rawX;
+  float y = rawY;
+  applyDeadZone(x, y);
+
+  // same algorithm as ResponsiveAnalogRead::getResponsiveValue(), but on the movement vector:
+  // error is tracked per axis and its length decides sleep, and one snap amount moves both axes
+  float dx = x - smoothX;
+  float dy = y - smoothY;
+  errorX += (dx - errorX) * 0.4;
+  errorY += (dy - errorY) * 0.4;
+
+  if(sleepEnable) {
+    sleeping = errorX * errorX + errorY * errorY < activityThreshold * activityThreshold;
+  }
+
+  if(!(sleepEnable && sleeping)) {
+    // snap curve from ResponsiveAnalogRead::snapCurve()
+    float snap = 1.0 / (sqrt(dx * dx + dy * dy) * snapMultiplier + 1.0);
+    snap = (1.0 - snap) * 2.0;
+    if(snap > 1.0) {
+      snap = 1.0;
+    }
+    smoothX = clampAxis(smoothX + dx * snap);
+    smoothY = clampAxis(smoothY + dy * snap);
+  }
+
+  responsiveX = (int)smoothX;
+  responsiveY = (int)smoothY;
+  responsiveValueHasChanged = responsiveX != prevX || responsiveY != prevY;
+}
+
+void ResponsiveJoystick::applyDeadZone(float& x, float& y)
+{
+  if(deadZone <= 0.0) {
+    return;
+  }
+
+  float dx = x - centerX;
+  float dy = y - centerY;
+  float distance = sqrt(dx * dx + dy * dy);
+  if(distance <= deadZone) {
+    x = centerX;
+    y = centerY;
+    return;
+  }
+
+  // pull everything outside the dead zone in along its own direction, so movement starts from zero
+  // at the dead zone edge and the full half range is still reachable
+  float halfRange = analogResolution / 2;
+  float scale = (distance - deadZone) / distance;
+  if(halfRange > deadZone) {
+    scale *= halfRange / (halfRange - deadZone);
+  }
+  x = centerX + dx * scale;
+  y = centerY + dy * scale;
+}
+
+float ResponsiveJoystick::clampAxis(float value)
+{
+  if(value < 0.0) {
+    return 0.0;
+  }
+  if(value > analogResolution - 1) {
+    return analogResolution - 1;
+  }
+  return value;
+}
+
+void ResponsiveJoystick::setSnapMultiplier(float newMultiplier)
+{
+  if(newMultiplier > 1.0) {
+    newMultiplier = 1.0;
+  }
+  if(newMultiplier < 0.0) {
+    newMultiplier = 0.0;
+  }
+  snapMultiplier = newMultiplier;
+}
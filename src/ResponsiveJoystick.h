@@ -0,0 +1,95 @@
+/*
+ * ResponsiveJoystick.h
+ * Two axis ResponsiveAnalogRead filter with a radial dead zone and a shared sleep state
+ *
+ * Copyright (c) 2016 Damien Clarke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef RESPONSIVE_JOYSTICK_H
+#define RESPONSIVE_JOYSTICK_H
+
+#include <Arduino.h>
+
+class ResponsiveJoystick
+{
+  public:
+
+    // pinX, pinY - the pins to read
+    // sleepEnable and snapMultiplier work as in ResponsiveAnalogRead, but activity, sleep and snap are
+    // decided once on the length of the 2-D movement, so both axes wake, ease and sleep together
+    ResponsiveJoystick(){};  //default constructor must be followed by call to begin function
+    ResponsiveJoystick(int pinX, int pinY, bool sleepEnable, float snapMultiplier = 0.01){
+        begin(pinX, pinY, sleepEnable, snapMultiplier);
+    };
+
+    void begin(int pinX, int pinY, bool sleepEnable, float snapMultiplier = 0.01);  // use with default constructor to initialize
+
+    inline int getX() { return responsiveX; } // get the responsive x value from last update
+    inline int getY() { return responsiveY; } // get the responsive y value from last update
+    inline int getRawX() { return rawX; }
+    inline int getRawY() { return rawY; }
+    inline bool hasChanged() { return responsiveValueHasChanged; } // returns true if either axis changed during the last update
+    inline bool isSleeping() { return sleeping; }
+    void update(); // reads both pins and updates both axes
+    void update(int rawXRead, int rawYRead); // updates both axes from values read elsewhere
+
+    void setSnapMultiplier(float newMultiplier);
+    inline void enableSleep() { sleepEnable = true; }
+    inline void disableSleep() { sleepEnable = false; }
+    inline void setActivityThreshold(float newThreshold) { activityThreshold = newThreshold; }
+    // the length of 2-D movement that must take place to register as activity. Defaults to 4.0
+    void setAnalogResolution(int resolution);
+    // also moves the center to the middle of the new range, call setCenter() afterwards for a stick that rests elsewhere
+    void setCenter(int x, int y);
+    // both restart the smoothing from the center, so the outputs don't drift over from the old one
+    inline void setDeadZone(float radius) { deadZone = radius > 0.0 ? radius : 0.0; }
+    // readings closer to the center than radius are treated as centered, and the rest of the range is
+    // stretched so the edges can still be reached. Defaults to 0 (off)
+
+  private:
+    int pinX = 0;
+    int pinY = 0;
+    int analogResolution = 1024;
+    float snapMultiplier = 0.01;
+    bool sleepEnable = true;
+    float activityThreshold = 4.0;
+    float deadZone = 0.0;
+    int centerX = 512;
+    int centerY = 512;
+
+    float smoothX = 512.0;
+    float smoothY = 512.0;
+    float errorX = 0.0;
+    float errorY = 0.0;
+    bool sleeping = false;
+
+    int rawX = 512;
+    int rawY = 512;
+    int responsiveX = 512;
+    int responsiveY = 512;
+    bool responsiveValueHasChanged = false;
+
+    void restartAtCenter();
+    void applyDeadZone(float& x, float& y);
+    float clampAxis(float value);
+};
+
+#endif
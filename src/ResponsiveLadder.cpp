@@ -0,0 +1,99 @@
+/*
+ * ResponsiveLadder.cpp
+ * Decodes resistor ladder buttons read through ResponsiveAnalogRead into press and release events
+ *
+ * Copyright (c) 2016 Damien Clarke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <Arduino.h>
+#include "ResponsiveLadder.h"
+
+void ResponsiveLadder::begin(const int* thresholds, uint8_t count, uint8_t idleLevel, uint8_t debounceSamples)
+{
+  this->thresholds = thresholds;
+  this->count = count;
+  this->idleLevel = idleLevel;
+  this->debounceSamples = debounceSamples;
+  candidate = RESPONSIVE_LADDER_NONE;
+  stableSamples = 0;
+  button = RESPONSIVE_LADDER_NONE;
+  eventButton = RESPONSIVE_LADDER_NONE;
+}
+
+uint8_t ResponsiveLadder::classify(int value)
+{
+  // find the number of thresholds at or below value
+  uint8_t low = 0;
+  uint8_t high = count;
+  while(low < high) {
+    uint8_t mid = (low + high) >> 1;
+    if(value >= thresholds[mid]) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+
+  if(low == idleLevel) {
+    return RESPONSIVE_LADDER_NONE;
+  }
+  return low > idleLevel ? low - 1 : low;
+}
+
+ResponsiveLadderEvent ResponsiveLadder::update(ResponsiveAnalogRead& input)
+{
+  return update(input.getValue(), input.isSleeping() || !input.hasChanged());
+}
+
+ResponsiveLadderEvent ResponsiveLadder::update(int value, bool settled)
+{
+  if(!settled) {
+    stableSamples = 0;
+    return RESPONSIVE_LADDER_NO_EVENT;
+  }
+
+  uint8_t level = classify(value);
+  if(level != candidate) {
+    candidate = level;
+    stableSamples = 0;
+  }
+  if(stableSamples < debounceSamples) {
+    stableSamples++;
+    if(stableSamples < debounceSamples) {
+      return RESPONSIVE_LADDER_NO_EVENT;
+    }
+  }
+
+  if(candidate == button) {
+    return RESPONSIVE_LADDER_NO_EVENT;
+  }
+
+  // going straight from one button to another releases the first, the new one is pressed on a later update
+  if(button != RESPONSIVE_LADDER_NONE) {
+    eventButton = button;
+    button = RESPONSIVE_LADDER_NONE;
+    return RESPONSIVE_LADDER_RELEASE;
+  }
+
+  button = candidate;
+  eventButton = button;
+  return RESPONSIVE_LADDER_PRESS;
+}
@@ -0,0 +1,75 @@
+/*
+ * ResponsiveLadder.h
+ * Decodes resistor ladder buttons read through ResponsiveAnalogRead into press and release events
+ *
+ * Copyright (c) 2016 Damien Clarke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef RESPONSIVE_LADDER_H
+#define RESPONSIVE_LADDER_H
+
+#include <Arduino.h>
+#include "ResponsiveAnalogRead.h"
+
+#define RESPONSIVE_LADDER_NONE 0xFF
+
+enum ResponsiveLadderEvent {
+  RESPONSIVE_LADDER_NO_EVENT = 0,
+  RESPONSIVE_LADDER_PRESS,
+  RESPONSIVE_LADDER_RELEASE
+};
+
+class ResponsiveLadder
+{
+  public:
+
+    // thresholds - caller owned, ascending boundaries between ladder levels. A value below thresholds[0] is level 0,
+    //   a value between thresholds[i - 1] and thresholds[i] is level i, and a value above the last one is level count
+    // idleLevel - the level read when no button is pressed (often count, the highest voltage, with a pull-up)
+    // debounceSamples - how many settled updates in a row a new level must be seen for before it is reported
+    // buttons are numbered by level, skipping the idle level
+    void begin(const int* thresholds, uint8_t count, uint8_t idleLevel, uint8_t debounceSamples = 3);
+    inline void setDebounce(uint8_t samples) { debounceSamples = samples; }
+
+    // classify a value against the thresholds, binary search so long ladders cost log2(count) compares
+    uint8_t classify(int value);
+
+    // feed the filter after each update, a level is only counted while the filter is settled
+    // (sleeping, or not changing) so the ramp between two levels never registers as a press
+    ResponsiveLadderEvent update(ResponsiveAnalogRead& input);
+    ResponsiveLadderEvent update(int value, bool settled);
+
+    inline uint8_t getButton() { return button; } // the button held down, or RESPONSIVE_LADDER_NONE
+    inline uint8_t getEventButton() { return eventButton; } // the button the last press or release event was about
+
+  private:
+    const int* thresholds = NULL;
+    uint8_t count = 0;
+    uint8_t idleLevel = 0;
+    uint8_t debounceSamples = 3;
+
+    uint8_t candidate = RESPONSIVE_LADDER_NONE;
+    uint8_t stableSamples = 0;
+    uint8_t button = RESPONSIVE_LADDER_NONE;
+    uint8_t eventButton = RESPONSIVE_LADDER_NONE;
+};
+
+#endif
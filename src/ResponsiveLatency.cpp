@@ -0,0 +1,143 @@
+/*
+ * ResponsiveLatency.cpp
+ * Update latency histograms and sample arrival jitter tracking for ResponsiveAnalogRead
+ *
+ * Copyright (c) 2016 Damien Clarke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <Arduino.h>
+#include "ResponsiveLatency.h"
+
+uint8_t ResponsiveLatencyHistogram::bucketOf(uint32_t us)
+{
+  if(us < 2) {
+    return us;
+  }
+  // octave from the highest set bit, then the next bit down picks the lower or upper half of it
+  uint8_t octave = (sizeof(unsigned long) * 8 - 1) - __builtin_clzl(us);
+  if(octave >= RESPONSIVE_LATENCY_OCTAVES) {
+    return RESPONSIVE_LATENCY_BUCKETS - 1;
+  }
+  return 2 * octave + ((us >> (octave - 1)) & 1);
+}
+
+uint32_t ResponsiveLatencyHistogram::bucketLower(uint8_t bucket)
+{
+  if(bucket < 2) {
+    return bucket;
+  }
+  uint8_t octave = bucket >> 1;
+  return (uint32_t)(2 | (bucket & 1)) << (octave - 1);
+}
+
+uint32_t ResponsiveLatencyHistogram::bucketUpper(uint8_t bucket)
+{
+  if(bucket + 1 >= RESPONSIVE_LATENCY_BUCKETS) {
+    return 0xFFFFFFFF;
+  }
+  return bucketLower(bucket + 1) - 1;
+}
+
+void ResponsiveLatencyHistogram::record(uint32_t us)
+{
+  buckets[bucketOf(us)]++;
+  count++;
+  total += us;
+  if(us < min) {
+    min = us;
+  }
+  if(us > max) {
+    max = us;
+  }
+}
+
+void ResponsiveLatencyHistogram::reset()
+{
+  for(uint8_t i = 0; i < RESPONSIVE_LATENCY_BUCKETS; i++) {
+    buckets[i] = 0;
+  }
+  count = 0;
+  min = 0xFFFFFFFF;
+  max = 0;
+  total = 0;
+}
+
+uint32_t ResponsiveLatencyHistogram::getPercentile(float fraction)
+{
+  if(count == 0) {
+    return 0;
+  }
+  uint32_t target = (uint32_t)(fraction * count);
+  if(target >= count) {
+    target = count - 1;
+  }
+
+  uint32_t seen = 0;
+  for(uint8_t i = 0; i < RESPONSIVE_LATENCY_BUCKETS; i++) {
+    seen += buckets[i];
+    if(seen > target) {
+      // never report more than was actually seen
+      uint32_t upper = bucketUpper(i);
+      return upper < max ? upper : max;
+    }
+  }
+  return max;
+}
+
+void ResponsiveJitter::arrival(uint32_t nowUS)
+{
+  if(!started) {
+    started = true;
+    lastUS = nowUS;
+    return;
+  }
+
+  uint32_t interval = nowUS - lastUS;
+  lastUS = nowUS;
+  histogram.record(interval);
+
+  if(intervals == 0) {
+    meanInterval = interval;
+  }
+  intervals++;
+  if(interval < minInterval) {
+    minInterval = interval;
+  }
+  if(interval > maxInterval) {
+    maxInterval = interval;
+  }
+
+  // the same kind of exponential moving averages the filter uses for its error
+  float deviation = interval - meanInterval;
+  meanInterval += deviation * 0.05;
+  jitter += ((deviation < 0.0 ? -deviation : deviation) - jitter) * 0.05;
+}
+
+void ResponsiveJitter::reset()
+{
+  histogram.reset();
+  intervals = 0;
+  minInterval = 0xFFFFFFFF;
+  maxInterval = 0;
+  meanInterval = 0.0;
+  jitter = 0.0;
+  started = false;
+}
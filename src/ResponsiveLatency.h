@@ -0,0 +1,91 @@
+/*
+ * ResponsiveLatency.h
+ * Update latency histograms and sample arrival jitter tracking for ResponsiveAnalogRead
+ *
+ * Copyright (c) 2016 Damien Clarke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef RESPONSIVE_LATENCY_H
+#define RESPONSIVE_LATENCY_H
+
+#include <Arduino.h>
+
+// buckets cover 0 to 2^RESPONSIVE_LATENCY_OCTAVES microseconds, two per power of two
+// (so each bucket is at most 50% wide), anything longer lands in the last bucket
+#ifndef RESPONSIVE_LATENCY_OCTAVES
+#define RESPONSIVE_LATENCY_OCTAVES 24
+#endif
+#define RESPONSIVE_LATENCY_BUCKETS (2 * RESPONSIVE_LATENCY_OCTAVES)
+
+// records durations in microseconds into fixed log scaled buckets, O(1) per record
+class ResponsiveLatencyHistogram
+{
+  public:
+    void record(uint32_t us);
+    void reset();
+
+    inline uint32_t getCount() { return count; }
+    inline uint32_t getMin() { return count ? min : 0; }
+    inline uint32_t getMax() { return max; }
+    inline uint32_t getMean() { return count ? (uint32_t)(total / count) : 0; }
+    // the upper edge of the bucket holding the given fraction of records, e.g. 0.999 for p99.9
+    uint32_t getPercentile(float fraction);
+
+    inline uint32_t getBucketCount(uint8_t bucket) { return buckets[bucket]; }
+    static uint32_t bucketLower(uint8_t bucket);
+    static uint32_t bucketUpper(uint8_t bucket);
+
+  private:
+    uint32_t buckets[RESPONSIVE_LATENCY_BUCKETS] = {0};
+    uint32_t count = 0;
+    uint32_t min = 0xFFFFFFFF;
+    uint32_t max = 0;
+    uint64_t total = 0;
+
+    static uint8_t bucketOf(uint32_t us);
+};
+
+// tracks the interval between sample arrivals and how much it wanders
+class ResponsiveJitter
+{
+  public:
+    void arrival(uint32_t nowUS); // call when a sample or frame arrives, usually with micros()
+    inline void arrival() { arrival(micros()); }
+    void reset();
+
+    inline float getMeanInterval() { return meanInterval; } // moving average of the interval, microseconds
+    inline float getJitter() { return jitter; } // moving average of the distance from the mean interval, microseconds
+    inline uint32_t getMinInterval() { return intervals ? minInterval : 0; }
+    inline uint32_t getMaxInterval() { return maxInterval; }
+    inline ResponsiveLatencyHistogram& getHistogram() { return histogram; } // every interval, for tail analysis
+
+  private:
+    ResponsiveLatencyHistogram histogram;
+    uint32_t lastUS = 0;
+    uint32_t intervals = 0;
+    uint32_t minInterval = 0xFFFFFFFF;
+    uint32_t maxInterval = 0;
+    float meanInterval = 0.0;
+    float jitter = 0.0;
+    bool started = false;
+};
+
+#endif
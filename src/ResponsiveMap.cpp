@@ -0,0 +1,249 @@
+/*
+ * ResponsiveMap.cpp
+ * Compact, owned multiMap() tables for ResponsiveAnalogRead
+ *
+ * Copyright (c) 2016 Damien Clarke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <Arduino.h>
+#include "ResponsiveMap.h"
+
+void ResponsiveMap::clear()
+{
+  location = RAM;
+  lutLength = 0;
+  index = NULL;
+  in = NULL;
+  out = NULL;
+  inverseTable = NULL;
+  size = 0;
+  shift = 0;
+}
+
+bool ResponsiveMap::begin(void* arena, size_t arenaBytes, const int* in, const int* out, uint8_t size)
+{
+  // a failed begin() must not leave the previous table, or its inverse, reachable
+  clear();
+  if(size == 0 || arenaBytes < (size_t)RESPONSIVE_MAP_BYTES(size)) {
+    return false;
+  }
+  for(uint8_t i = 0; i < size; i++) {
+    if(in[i] < 0 || (long)in[i] > 0xFFFF || out[i] < 0 || out[i] > 0xFF) {
+      return false;
+    }
+    if(i > 0 && in[i] <= in[i - 1]) {
+      return false;
+    }
+  }
+
+  // keep the uint16_t inputs 2 byte aligned whatever the arena's alignment
+  uint8_t* block = (uint8_t*)arena;
+  if((uintptr_t)block & 1) {
+    block++;
+  }
+  uint8_t* newIndex = block;
+  uint16_t* newIn = (uint16_t*)(block + RESPONSIVE_MAP_INDEX);
+  uint8_t* newOut = (uint8_t*)(newIn + size);
+
+  for(uint8_t i = 0; i < size; i++) {
+    newIn[i] = in[i];
+    newOut[i] = out[i];
+  }
+
+  // bucket values by their top bits, and remember the first segment each bucket can land in
+  uint8_t newShift = 0;
+  while((newIn[size - 1] >> newShift) >= RESPONSIVE_MAP_INDEX) {
+    newShift++;
+  }
+  uint8_t pos = 1;
+  for(uint8_t b = 0; b < RESPONSIVE_MAP_INDEX; b++) {
+    uint32_t bucketStart = (uint32_t)b << newShift;
+    while(pos < size - 1 && newIn[pos] < bucketStart) {
+      pos++;
+    }
+    newIndex[b] = pos;
+  }
+
+  index = newIndex;
+  this->in = newIn;
+  this->out = newOut;
+  shift = newShift;
+  this->size = size;
+
+  // with room to spare, precompute the inverse for every output value, right after the forward tables
+  bool rising = true;
+  for(uint8_t i = 1; i < size; i++) {
+    rising &= newOut[i] >= newOut[i - 1];
+  }
+  if(rising && arenaBytes >= (size_t)RESPONSIVE_MAP_INVERSE_BYTES(size)) {
+    uint8_t* after = newOut + size;
+    if((uintptr_t)after & 1) {
+      after++;
+    }
+    uint16_t* newInverse = (uint16_t*)after;
+    for(uint16_t v = 0; v < 256; v++) {
+      newInverse[v] = inverseSearch(v);
+    }
+    inverseTable = newInverse;
+  }
+  return true;
+}
+
+bool ResponsiveMap::beginProgmem(const uint16_t* in, const uint8_t* out, uint8_t size)
+{
+  clear();
+  if(size == 0) {
+    return false;
+  }
+  // the binary search in lookupProgmem() needs strictly ascending inputs, which noisy samples don't always give
+  for(uint8_t i = 1; i < size; i++) {
+    if(pgm_read_word(in + i) <= pgm_read_word(in + i - 1)) {
+      return false;
+    }
+  }
+  location = FLASH_TABLE;
+  this->in = in;
+  this->out = out;
+  this->size = size;
+  return true;
+}
+
+bool ResponsiveMap::beginLut(const uint8_t* lut, uint16_t length)
+{
+  clear();
+  if(length == 0) {
+    return false;
+  }
+  location = FLASH_LUT;
+  out = lut;
+  lutLength = length;
+  // size only marks the map as usable, a LUT has no points
+  this->size = 1;
+  return true;
+}
+
+uint8_t ResponsiveMap::lookup(int val) const
+{
+  if(size == 0) {
+    return 0;
+  }
+  if(location != RAM) {
+    return lookupProgmem(val);
+  }
+  if(val <= in[0]) return out[0];
+  if(val >= in[size - 1]) return out[size - 1];
+
+  // val is inside the table, so val >> shift is a valid bucket and the scan ends within the bucket
+  uint8_t pos = index[val >> shift];
+  while(val > in[pos]) pos++;
+
+  if(val == in[pos]) return out[pos];
+  // long math, the product overflows a 16 bit int on AVR
+  return (long)(val - in[pos - 1]) * (out[pos] - out[pos - 1]) / (in[pos] - in[pos - 1]) + out[pos - 1];
+}
+
+uint8_t ResponsiveMap::lookupProgmem(int val) const
+{
+  if(location == FLASH_LUT) {
+    if(val < 0) val = 0;
+    if((uint16_t)val >= lutLength) val = lutLength - 1;
+    return pgm_read_byte(out + val);
+  }
+
+  uint16_t first = pgm_read_word(in);
+  uint16_t last = pgm_read_word(in + size - 1);
+  if(val <= (long)first) return pgm_read_byte(out);
+  if(val >= (long)last) return pgm_read_byte(out + size - 1);
+
+  // flash reads are slower than RAM and there's no index here, so binary search for the
+  // first point at or above val: log2(size) reads instead of a linear walk
+  uint8_t low = 1;
+  uint8_t high = size - 1;
+  while(low < high) {
+    uint8_t mid = (low + high) >> 1;
+    if((long)pgm_read_word(in + mid) < val) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+
+  uint16_t inHigh = pgm_read_word(in + low);
+  uint8_t outHigh = pgm_read_byte(out + low);
+  if(val == (long)inHigh) return outHigh;
+  uint16_t inLow = pgm_read_word(in + low - 1);
+  uint8_t outLow = pgm_read_byte(out + low - 1);
+  return (long)(val - inLow) * (outHigh - outLow) / (inHigh - inLow) + outLow;
+}
+
+int ResponsiveMap::inverse(uint8_t value) const
+{
+  if(inverseTable) {
+    return inverseTable[value];
+  }
+  return inverseSearch(value);
+}
+
+int ResponsiveMap::inverseSearch(uint8_t value) const
+{
+  if(size == 0) {
+    return 0;
+  }
+  if(location == FLASH_LUT) {
+    // first raw value that reaches the output
+    uint16_t low = 0;
+    uint16_t high = lutLength - 1;
+    while(low < high) {
+      uint16_t mid = (low + high) >> 1;
+      if(pgm_read_byte(out + mid) < value) {
+        low = mid + 1;
+      } else {
+        high = mid;
+      }
+    }
+    return low;
+  }
+
+  if(value <= getOut(0)) return getIn(0);
+  // a flat tail reaches value before the last point, the search below finds where
+  if(value > getOut(size - 1)) return getIn(size - 1);
+
+  // first point whose output reaches value, then interpolate back along that segment
+  uint8_t low = 1;
+  uint8_t high = size - 1;
+  while(low < high) {
+    uint8_t mid = (low + high) >> 1;
+    if(getOut(mid) < value) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+
+  uint8_t outHigh = getOut(low);
+  uint8_t outLow = getOut(low - 1);
+  uint16_t inHigh = getIn(low);
+  uint16_t inLow = getIn(low - 1);
+  if(value == outHigh) return inHigh;
+  // outLow < value < outHigh here. lookup() rounds down, so round up to get the first raw value
+  // whose lookup() reaches value, as the LUT search does
+  return ((long)(value - outLow) * (inHigh - inLow) + (outHigh - outLow) - 1) / (outHigh - outLow) + inLow;
+}
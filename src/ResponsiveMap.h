@@ -0,0 +1,101 @@
+/*
+ * ResponsiveMap.h
+ * Compact, owned multiMap() tables for ResponsiveAnalogRead
+ *
+ * Copyright (c) 2016 Damien Clarke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef RESPONSIVE_MAP_H
+#define RESPONSIVE_MAP_H
+
+#include <Arduino.h>
+
+// cores without flash address spaces read PROGMEM data like any other memory
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+#ifndef pgm_read_word
+#define pgm_read_word(addr) (*(const unsigned short*)(addr))
+#endif
+#ifndef pgm_read_byte
+#define pgm_read_byte(addr) (*(const unsigned char*)(addr))
+#endif
+
+// entries in the coarse segment index stored in front of every table
+#define RESPONSIVE_MAP_INDEX 16
+// bytes of arena a table with size points needs
+#define RESPONSIVE_MAP_BYTES(size) (RESPONSIVE_MAP_INDEX + 3 * (size) + 1)
+// bytes of arena a table with size points needs to also hold its inverse, one raw value per output 0-255
+#define RESPONSIVE_MAP_INVERSE_BYTES(size) (RESPONSIVE_MAP_BYTES(size) + 1 + 2 * 256)
+
+// A piecewise linear mapping from raw readings (uint16_t) to byte outputs (uint8_t), with the same
+// interpolation as ResponsiveAnalogRead::multiMap(). begin() copies the caller's tables into an arena the
+// caller hands over, so the source arrays can go away afterwards and the table can't change underneath a lookup.
+// The arena holds, in one block: a segment index so a lookup starts next to the right segment, the inputs, the outputs.
+class ResponsiveMap
+{
+  public:
+
+    // arena - caller owned, at least RESPONSIVE_MAP_BYTES(size) bytes, and must outlive the map
+    //   with RESPONSIVE_MAP_INVERSE_BYTES(size) bytes the inverse table is built as well, if out never decreases
+    // in - strictly ascending raw values, out - matching outputs 0-255
+    // returns false (and leaves the map empty) if the arena is too small or the tables don't fit the narrow types
+    bool begin(void* arena, size_t arenaBytes, const int* in, const int* out, uint8_t size);
+
+    // use tables that live in flash, declared as const uint16_t in[] PROGMEM and const uint8_t out[] PROGMEM
+    // (calibrate() prints them in that form too). Nothing is copied to RAM, lookups read flash with a binary search.
+    // returns false (and leaves the map empty) unless in is strictly ascending
+    bool beginProgmem(const uint16_t* in, const uint8_t* out, uint8_t size);
+
+    // use a precomputed lookup table in flash with one output per raw value, const uint8_t lut[] PROGMEM.
+    // Raw values past the end of the table read the last entry
+    bool beginLut(const uint8_t* lut, uint16_t length);
+
+    uint8_t lookup(int val) const;
+
+    // the first raw value whose lookup() reaches an output, e.g. a motorized fader's setpoint for a target value.
+    // Interpolates between the same points as lookup(), O(1) when the inverse table was built,
+    // otherwise a binary search over the outputs (which must not decrease)
+    int inverse(uint8_t value) const;
+    inline bool hasInverseTable() const { return inverseTable != NULL; }
+
+    inline uint8_t getSize() const { return size; }
+    inline uint16_t getIn(uint8_t i) const { return location == RAM ? in[i] : pgm_read_word(in + i); }
+    inline uint8_t getOut(uint8_t i) const { return location == RAM ? out[i] : pgm_read_byte(out + i); }
+
+  private:
+    enum Location { RAM, FLASH_TABLE, FLASH_LUT };
+    Location location = RAM;
+    uint16_t lutLength = 0;
+
+    const uint8_t* index = NULL;
+    const uint16_t* in = NULL;
+    const uint8_t* out = NULL;
+    const uint16_t* inverseTable = NULL;
+    uint8_t size = 0;
+    uint8_t shift = 0;
+
+    void clear();
+    uint8_t lookupProgmem(int val) const;
+    int inverseSearch(uint8_t value) const;
+};
+
+#endif
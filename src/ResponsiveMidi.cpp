@@ -0,0 +1,82 @@
+/*
+ * ResponsiveMidi.cpp
+ * 14-bit MIDI control change encoder fed directly from a ResponsiveAnalogRead filter
+ *
+ * Copyright (c) 2016 Damien Clarke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <Arduino.h>
+#include "ResponsiveMidi.h"
+
+uint8_t ResponsiveMidiPort::writeStatus(uint8_t status, uint8_t* out)
+{
+  if(runningStatusEnable && status == runningStatus) {
+    return 0;
+  }
+  out[0] = status;
+  runningStatus = runningStatusEnable ? status : 0;
+  return 1;
+}
+
+void ResponsiveMidiCC14::begin(ResponsiveMidiPort& port, uint8_t channel, uint8_t controller)
+{
+  this->port = &port;
+  this->status = 0xB0 | (channel & 0x0F);
+  this->controller = controller & 0x1F;
+  sent = false;
+}
+
+uint8_t ResponsiveMidiCC14::encode(uint16_t value, uint8_t* out)
+{
+  if(value > 16383) {
+    value = 16383;
+  }
+  uint8_t newMsb = value >> 7;
+  uint8_t newLsb = value & 0x7F;
+  uint8_t length = 0;
+
+  // receivers reset the LSB when a new MSB arrives, so the MSB always goes first and the LSB must follow it
+  if(!sent || newMsb != msb) {
+    length += port->writeStatus(status, out + length);
+    out[length++] = controller;
+    out[length++] = newMsb;
+  } else if(newLsb == lsb) {
+    return 0;
+  }
+
+  length += port->writeStatus(status, out + length);
+  out[length++] = controller + 32;
+  out[length++] = newLsb;
+
+  msb = newMsb;
+  lsb = newLsb;
+  sent = true;
+  return length;
+}
+
+uint8_t ResponsiveMidiCC14::encode(ResponsiveAnalogRead& input, uint8_t* out)
+{
+  float value = input.getSmoothValue() * 16383.0 / (input.getAnalogResolution() - 1);
+  if(value < 0.0) {
+    value = 0.0;
+  }
+  return encode((uint16_t)(value + 0.5), out);
+}
@@ -0,0 +1,81 @@
+/*
+ * ResponsiveMidi.h
+ * 14-bit MIDI control change encoder fed directly from a ResponsiveAnalogRead filter
+ *
+ * Copyright (c) 2016 Damien Clarke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef RESPONSIVE_MIDI_H
+#define RESPONSIVE_MIDI_H
+
+#include <Arduino.h>
+#include "ResponsiveAnalogRead.h"
+
+// the most bytes a single encode() call can produce: two full control change messages
+#define RESPONSIVE_MIDI_MAX_BYTES 6
+
+// state shared by everything written to one MIDI output, used for running status
+class ResponsiveMidiPort
+{
+  public:
+    inline void enableRunningStatus() { runningStatusEnable = true; }
+    inline void disableRunningStatus() { runningStatusEnable = false; runningStatus = 0; }
+    // call this after sending any other message on the same output, so the next message carries its status byte again
+    inline void resetRunningStatus() { runningStatus = 0; }
+
+    // writes the status byte unless running status makes it redundant, returns the number of bytes written
+    uint8_t writeStatus(uint8_t status, uint8_t* out);
+
+  private:
+    bool runningStatusEnable = true;
+    uint8_t runningStatus = 0;
+};
+
+// one 14-bit controller: the MSB goes out on controller (0-31) and the LSB on controller + 32
+class ResponsiveMidiCC14
+{
+  public:
+
+    // channel - MIDI channel 0-15
+    // controller - MSB controller number 0-31
+    void begin(ResponsiveMidiPort& port, uint8_t channel, uint8_t controller);
+
+    // encode a 14-bit value (0-16383) into out, which must hold RESPONSIVE_MIDI_MAX_BYTES
+    // returns the number of bytes written: nothing when the value didn't change,
+    // only the LSB message when the MSB is unchanged, otherwise MSB then LSB
+    uint8_t encode(uint16_t value, uint8_t* out);
+
+    // encode the unrounded filter output scaled to 14 bits, so a 10 or 12 bit ADC still moves the LSB smoothly
+    uint8_t encode(ResponsiveAnalogRead& input, uint8_t* out);
+
+    // forget what was sent, so the next encode() sends both bytes (e.g. after the receiver reconnects)
+    inline void invalidate() { sent = false; }
+
+  private:
+    ResponsiveMidiPort* port = NULL;
+    uint8_t status = 0xB0;
+    uint8_t controller = 0;
+    uint8_t msb = 0;
+    uint8_t lsb = 0;
+    bool sent = false;
+};
+
+#endif
@@ -0,0 +1,79 @@
+/*
+ * ResponsiveOutputLimiter.cpp
+ * Coalesces ResponsiveAnalogRead changes and rate limits them per channel for MIDI/OSC style outputs
+ *
+ * Copyright (c) 2016 Damien Clarke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <Arduino.h>
+#include "ResponsiveOutputLimiter.h"
+
+void ResponsiveOutputLimiter::begin(ResponsiveOutputSlot* slots, uint8_t count, unsigned long intervalMS)
+{
+  this->slots = slots;
+  this->count = count;
+  this->intervalMS = intervalMS;
+  cursor = 0;
+
+  for(uint8_t i = 0; i < count; i++) {
+    slots[i].value = 0;
+    slots[i].sentValue = 0;
+    slots[i].lastSentMS = 0;
+    slots[i].pending = false;
+    slots[i].hasSent = false;
+  }
+}
+
+void ResponsiveOutputLimiter::offer(uint8_t channel, int value)
+{
+  ResponsiveOutputSlot& slot = slots[channel];
+  slot.value = value;
+  // a knob that wanders away and back within one interval doesn't need to send anything
+  slot.pending = !slot.hasSent || value != slot.sentValue;
+}
+
+bool ResponsiveOutputLimiter::poll(uint8_t& channel, int& value)
+{
+  unsigned long now = millis();
+
+  // round robin from where the last poll stopped, so one busy channel can't starve the others
+  for(uint8_t n = 0; n < count; n++) {
+    uint8_t i = cursor;
+    cursor = (cursor + 1 < count) ? cursor + 1 : 0;
+
+    ResponsiveOutputSlot& slot = slots[i];
+    if(!slot.pending) {
+      continue;
+    }
+    if(slot.hasSent && now - slot.lastSentMS < intervalMS) {
+      continue;
+    }
+
+    slot.sentValue = slot.value;
+    slot.lastSentMS = now;
+    slot.pending = false;
+    slot.hasSent = true;
+    channel = i;
+    value = slot.value;
+    return true;
+  }
+  return false;
+}
@@ -0,0 +1,73 @@
+/*
+ * ResponsiveOutputLimiter.h
+ * Coalesces ResponsiveAnalogRead changes and rate limits them per channel for MIDI/OSC style outputs
+ *
+ * Copyright (c) 2016 Damien Clarke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef RESPONSIVE_OUTPUT_LIMITER_H
+#define RESPONSIVE_OUTPUT_LIMITER_H
+
+#include <Arduino.h>
+#include "ResponsiveAnalogRead.h"
+
+// per channel state, the caller owns an array of these (one per channel) so no heap is used
+struct ResponsiveOutputSlot
+{
+  int value;                // latest value offered
+  int sentValue;            // last value handed out by poll()
+  unsigned long lastSentMS; // when sentValue went out
+  bool pending;             // value differs from sentValue and still has to go out
+  bool hasSent;
+};
+
+class ResponsiveOutputLimiter
+{
+  public:
+
+    // slots - caller owned array with one entry per channel
+    // intervalMS - minimum time between two values sent on the same channel
+    void begin(ResponsiveOutputSlot* slots, uint8_t count, unsigned long intervalMS);
+    inline void setInterval(unsigned long intervalMS) { this->intervalMS = intervalMS; }
+
+    // record the latest value of a channel, only the newest offered value is kept
+    void offer(uint8_t channel, int value);
+    inline void offer(uint8_t channel, ResponsiveAnalogRead& input) {
+      if(input.hasChanged()) {
+        offer(channel, input.getValue());
+      }
+    }
+
+    // get the next value that is due to be sent, returns false when nothing is due right now
+    // a channel that has been quiet for a whole interval goes out immediately (leading edge),
+    // and whatever was offered last always goes out once its interval has passed (trailing edge)
+    bool poll(uint8_t& channel, int& value);
+
+    inline bool isPending(uint8_t channel) { return slots[channel].pending; }
+
+  private:
+    ResponsiveOutputSlot* slots = NULL;
+    uint8_t count = 0;
+    uint8_t cursor = 0;
+    unsigned long intervalMS = 0;
+};
+
+#endif
@@ -0,0 +1,187 @@
+/*
+ * ResponsiveRegisterMap.cpp
+ * ResponsiveAnalogBank exposed as an I2C or SPI peripheral's register map
+ *
+ * Copyright (c) 2016 Damien Clarke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <Arduino.h>
+#include "ResponsiveRegisterMap.h"
+
+#define RESPONSIVE_REGISTER_MASK_BYTES (RESPONSIVE_REGISTER_CHANNELS / 8)
+
+void ResponsiveRegisterMap::begin(ResponsiveAnalogBank& bank)
+{
+  this->bank = &bank;
+  count = bank.getCount() < RESPONSIVE_REGISTER_CHANNELS ? bank.getCount() : RESPONSIVE_REGISTER_CHANNELS;
+  memset(snapshots, 0, sizeof(snapshots));
+  memset(unacknowledged, 0, sizeof(unacknowledged));
+  memset(sinceFront, 0, sizeof(sinceFront));
+  front = 0;
+  frame = 0;
+
+  // the ResponsiveAnalogRead defaults, sleep and edge snap on, threshold 4, snap multiplier 0.01
+  config[0] = RESPONSIVE_REGISTER_SLEEP | RESPONSIVE_REGISTER_EDGE_SNAP;
+  config[1] = 4;
+  config[2] = (uint8_t)655;
+  config[3] = (uint8_t)(655 >> 8);
+  configChanged = false;
+}
+
+void ResponsiveRegisterMap::publish()
+{
+  noInterrupts();
+  bool applyNow = configChanged;
+  configChanged = false;
+  uint8_t written[4];
+  memcpy(written, config, sizeof(written));
+  interrupts();
+
+  if(applyNow) {
+    applyConfig(written);
+  }
+
+  // only publish() moves the front, so the back copy can be filled without locking out the handlers
+  Snapshot& back = snapshots[front ^ 1];
+  back.frame = ++frame;
+  memset(back.sleeping, 0, sizeof(back.sleeping));
+  for(uint8_t i = 0; i < count; i++) {
+    ResponsiveAnalogRead& channel = bank->getChannel(i);
+    uint8_t bit = 1 << (i & 7);
+    if(channel.hasChanged()) {
+      unacknowledged[i >> 3] |= bit;
+      sinceFront[i >> 3] |= bit;
+    }
+    if(channel.isSleeping()) {
+      back.sleeping[i >> 3] |= bit;
+    }
+    int value = channel.getValue();
+    back.values[i] = value < 0 ? 0 : (value > 0xFFFF ? 0xFFFF : value);
+  }
+
+  // an acknowledgement is taken together with the swap, so it always refers to the frame the host actually read:
+  // the host has seen every change up to the frame at the front, it still needs to hear about the ones after it.
+  // while the host is reading, its copy stays put and this frame is overwritten by the next one instead
+  noInterrupts();
+  if(acknowledged) {
+    acknowledged = false;
+    memcpy(unacknowledged, sinceFront, sizeof(unacknowledged));
+  }
+  memcpy(back.changed, unacknowledged, sizeof(back.changed));
+  if(!inTransaction) {
+    front ^= 1;
+    memset(sinceFront, 0, sizeof(sinceFront));
+  }
+  interrupts();
+}
+
+void ResponsiveRegisterMap::applyConfig(const uint8_t* config)
+{
+  float snapMultiplier = (config[2] | (config[3] << 8)) / 65536.0;
+  for(uint8_t i = 0; i < bank->getCount(); i++) {
+    ResponsiveAnalogRead& channel = bank->getChannel(i);
+    if(config[0] & RESPONSIVE_REGISTER_SLEEP) {
+      channel.enableSleep();
+    } else {
+      channel.disableSleep();
+    }
+    if(config[0] & RESPONSIVE_REGISTER_EDGE_SNAP) {
+      channel.enableEdgeSnap();
+    } else {
+      channel.disableEdgeSnap();
+    }
+    channel.setActivityThreshold(config[1]);
+    channel.setSnapMultiplier(snapMultiplier);
+  }
+}
+
+void ResponsiveRegisterMap::beginTransaction()
+{
+  inTransaction = true;
+  addressed = false;
+  readChanged = false;
+  wroteConfig = false;
+}
+
+void ResponsiveRegisterMap::write(uint8_t data)
+{
+  if(!addressed) {
+    address = data;
+    addressed = true;
+    return;
+  }
+  if(address >= RESPONSIVE_REGISTER_CONFIG && address < RESPONSIVE_REGISTER_CONFIG + sizeof(config)) {
+    config[address - RESPONSIVE_REGISTER_CONFIG] = data;
+    wroteConfig = true;
+  }
+  address++;
+}
+
+uint8_t ResponsiveRegisterMap::read()
+{
+  if(address >= RESPONSIVE_REGISTER_CHANGED && address < RESPONSIVE_REGISTER_CHANGED + RESPONSIVE_REGISTER_MASK_BYTES) {
+    readChanged = true;
+  }
+  return readRegister(address++);
+}
+
+void ResponsiveRegisterMap::endTransaction()
+{
+  // a multi-byte config write is only handed to the loop once it is complete
+  if(wroteConfig) {
+    configChanged = true;
+  }
+  if(readChanged) {
+    acknowledged = true;
+  }
+  inTransaction = false;
+}
+
+uint8_t ResponsiveRegisterMap::readRegister(uint8_t address)
+{
+  const Snapshot& current = snapshots[front];
+  if(address >= RESPONSIVE_REGISTER_VALUES) {
+    uint8_t index = (address - RESPONSIVE_REGISTER_VALUES) >> 1;
+    if(index >= count) {
+      return 0;
+    }
+    uint16_t value = current.values[index];
+    return address & 1 ? (uint8_t)(value >> 8) : (uint8_t)value;
+  }
+  if(address >= RESPONSIVE_REGISTER_CONFIG) {
+    return address < RESPONSIVE_REGISTER_CONFIG + sizeof(config) ? config[address - RESPONSIVE_REGISTER_CONFIG] : 0;
+  }
+  if(address >= RESPONSIVE_REGISTER_SLEEPING) {
+    return address < RESPONSIVE_REGISTER_SLEEPING + RESPONSIVE_REGISTER_MASK_BYTES ? current.sleeping[address - RESPONSIVE_REGISTER_SLEEPING] : 0;
+  }
+  if(address >= RESPONSIVE_REGISTER_CHANGED) {
+    return current.changed[address - RESPONSIVE_REGISTER_CHANGED];
+  }
+
+  switch(address) {
+    case RESPONSIVE_REGISTER_ID: return RESPONSIVE_REGISTER_ID_VALUE;
+    case RESPONSIVE_REGISTER_VERSION: return 1;
+    case RESPONSIVE_REGISTER_COUNT: return count;
+    case RESPONSIVE_REGISTER_FRAME: return (uint8_t)current.frame;
+    case RESPONSIVE_REGISTER_FRAME + 1: return (uint8_t)(current.frame >> 8);
+  }
+  return 0;
+}
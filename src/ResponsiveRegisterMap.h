@@ -0,0 +1,125 @@
+/*
+ * ResponsiveRegisterMap.h
+ * ResponsiveAnalogBank exposed as an I2C or SPI peripheral's register map
+ *
+ * Copyright (c) 2016 Damien Clarke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef RESPONSIVE_REGISTER_MAP_H
+#define RESPONSIVE_REGISTER_MAP_H
+
+#include <Arduino.h>
+#include "ResponsiveAnalogBank.h"
+
+// most channels one map can expose, a multiple of 8 and at most 64
+#ifndef RESPONSIVE_REGISTER_CHANNELS
+#define RESPONSIVE_REGISTER_CHANNELS 64
+#endif
+
+// register layout, 8 bit addresses, multi-byte registers little endian:
+//   0x00        id, RESPONSIVE_REGISTER_ID_VALUE
+//   0x01        layout version
+//   0x02        channel count
+//   0x04-0x05   frame counter, one more for every published frame
+//   0x08-0x0F   changed bitmask, channels that changed since the host last read any of these registers
+//               (reading again before the frame counter moves shows the same bits)
+//   0x10-0x17   sleeping bitmask
+//   0x20        config flags, RESPONSIVE_REGISTER_SLEEP | RESPONSIVE_REGISTER_EDGE_SNAP          (read/write)
+//   0x21        activity threshold in ADC units                                                  (read/write)
+//   0x22-0x23   snap multiplier in 1/65536ths                                                    (read/write)
+//   0x40-0xBF   responsive values, one uint16 per channel
+// unused addresses read as 0. Config registers read back what was last written, the library defaults until then
+#define RESPONSIVE_REGISTER_ID 0x00
+#define RESPONSIVE_REGISTER_VERSION 0x01
+#define RESPONSIVE_REGISTER_COUNT 0x02
+#define RESPONSIVE_REGISTER_FRAME 0x04
+#define RESPONSIVE_REGISTER_CHANGED 0x08
+#define RESPONSIVE_REGISTER_SLEEPING 0x10
+#define RESPONSIVE_REGISTER_CONFIG 0x20
+#define RESPONSIVE_REGISTER_THRESHOLD 0x21
+#define RESPONSIVE_REGISTER_SNAP 0x22
+#define RESPONSIVE_REGISTER_VALUES 0x40
+
+#define RESPONSIVE_REGISTER_ID_VALUE 0x52
+#define RESPONSIVE_REGISTER_SLEEP 0x01
+#define RESPONSIVE_REGISTER_EDGE_SNAP 0x02
+
+// Lets a small MCU act as an analog front end: it scans and filters a bank and a host reads the results over I2C or SPI.
+// Status registers are kept twice. The scanner always fills the back copy and only swaps it to the front while no
+// host transaction is running, so everything the host reads within one transaction comes from the same frame and
+// neither side ever waits for the other. Config written by the host is applied by the scanner on its next publish().
+class ResponsiveRegisterMap
+{
+  public:
+
+    // bank - at most RESPONSIVE_REGISTER_CHANNELS channels
+    void begin(ResponsiveAnalogBank& bank);
+
+    // call after every bank.update(), from the loop
+    void publish();
+
+    // transport side, call these from the I2C or SPI peripheral's handlers:
+    // beginTransaction() when the host addresses the device (I2C address match, SPI chip select),
+    // write() for every byte the host sends, the first one after beginTransaction() sets the register address
+    // and any further ones write config registers, read() for every byte the host clocks out,
+    // endTransaction() on stop or chip select release. The address advances after every byte and is kept
+    // between transactions, so an I2C write of the address followed by a read works as usual
+    void beginTransaction();
+    void write(uint8_t data);
+    uint8_t read();
+    void endTransaction();
+
+  private:
+    struct Snapshot
+    {
+      uint16_t frame;
+      uint8_t changed[RESPONSIVE_REGISTER_CHANNELS / 8];
+      uint8_t sleeping[RESPONSIVE_REGISTER_CHANNELS / 8];
+      uint16_t values[RESPONSIVE_REGISTER_CHANNELS];
+    };
+
+    ResponsiveAnalogBank* bank = NULL;
+    uint8_t count = 0;
+    Snapshot snapshots[2];
+    volatile uint8_t front = 0;
+    uint16_t frame = 0;
+
+    // changes not yet acknowledged by the host, and changes since the frame currently at the front
+    uint8_t unacknowledged[RESPONSIVE_REGISTER_CHANNELS / 8];
+    uint8_t sinceFront[RESPONSIVE_REGISTER_CHANNELS / 8];
+
+    // transport state, only touched by the handlers and by the loop with interrupts off
+    volatile bool inTransaction = false;
+    volatile bool acknowledged = false;
+    bool addressed = false;
+    bool readChanged = false;
+    bool wroteConfig = false;
+    uint8_t address = 0;
+
+    // config as written by the host, and whether it changed since the last publish()
+    volatile bool configChanged = false;
+    uint8_t config[4];
+
+    uint8_t readRegister(uint8_t address);
+    void applyConfig(const uint8_t* config);
+};
+
+#endif
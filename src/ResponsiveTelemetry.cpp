@@ -0,0 +1,97 @@
+/*
+ * ResponsiveTelemetry.cpp
+ * Compact binary telemetry frames for ResponsiveAnalogRead, sent through a non-blocking TX buffer
+ *
+ * Copyright (c) 2016 Damien Clarke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <Arduino.h>
+#include "ResponsiveTelemetry.h"
+
+uint8_t responsiveCrc8(const uint8_t* data, uint8_t length)
+{
+  uint8_t crc = 0;
+  while(length--) {
+    crc ^= *data++;
+    for(uint8_t i = 0; i < 8; i++) {
+      crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+bool ResponsiveTelemetry::push(uint8_t channel, int raw, int value, uint8_t flags)
+{
+  if(RESPONSIVE_TELEMETRY_BUFFER - getPending() < RESPONSIVE_TELEMETRY_FRAME_SIZE) {
+    dropped++;
+    return false;
+  }
+
+  unsigned long now = millis();
+  uint8_t frame[RESPONSIVE_TELEMETRY_FRAME_SIZE];
+  frame[0] = RESPONSIVE_TELEMETRY_SYNC;
+  frame[1] = channel;
+  frame[2] = (uint8_t)raw;
+  frame[3] = (uint8_t)(raw >> 8);
+  frame[4] = (uint8_t)value;
+  frame[5] = (uint8_t)(value >> 8);
+  frame[6] = flags;
+  frame[7] = (uint8_t)now;
+  frame[8] = (uint8_t)(now >> 8);
+  frame[9] = (uint8_t)(now >> 16);
+  frame[10] = (uint8_t)(now >> 24);
+  frame[11] = responsiveCrc8(frame + 1, RESPONSIVE_TELEMETRY_FRAME_SIZE - 2);
+
+  for(uint8_t i = 0; i < RESPONSIVE_TELEMETRY_FRAME_SIZE; i++) {
+    buffer[head++ & (RESPONSIVE_TELEMETRY_BUFFER - 1)] = frame[i];
+  }
+  return true;
+}
+
+void ResponsiveTelemetry::flush(Print& port)
+{
+  // only hand the port what fits in its own TX buffer, so write() never waits on the UART
+  int room = port.availableForWrite();
+  if(room > 0) {
+    portReportsRoom = true;
+  } else if(!portReportsRoom) {
+    // Print's default, SoftwareSerial and others always report 0. Until the port has reported room once,
+    // send one frame per call: write() may block for that long, but the buffer still drains
+    room = RESPONSIVE_TELEMETRY_FRAME_SIZE;
+  }
+  while(room > 0 && tail != head) {
+    // write the contiguous run up to the end of the ring in one call
+    uint16_t start = tail & (RESPONSIVE_TELEMETRY_BUFFER - 1);
+    uint16_t run = RESPONSIVE_TELEMETRY_BUFFER - start;
+    if(run > getPending()) {
+      run = getPending();
+    }
+    if(run > (uint16_t)room) {
+      run = (uint16_t)room;
+    }
+    size_t written = port.write(buffer + start, run);
+    if(written == 0) {
+      return;
+    }
+    tail += written;
+    room -= written;
+  }
+}
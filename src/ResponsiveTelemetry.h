@@ -0,0 +1,78 @@
+/*
+ * ResponsiveTelemetry.h
+ * Compact binary telemetry frames for ResponsiveAnalogRead, sent through a non-blocking TX buffer
+ *
+ * Copyright (c) 2016 Damien Clarke
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef RESPONSIVE_TELEMETRY_H
+#define RESPONSIVE_TELEMETRY_H
+
+#include <Arduino.h>
+
+// size of the TX ring buffer in bytes, must be a power of two
+// a full buffer drops whole frames instead of blocking the loop.
+// Changes sizeof(ResponsiveTelemetry), so set it as a global build flag, not with a #define in the sketch
+#ifndef RESPONSIVE_TELEMETRY_BUFFER
+#define RESPONSIVE_TELEMETRY_BUFFER 128
+#endif
+
+// frame layout (all multi-byte fields little endian):
+//   0     sync byte 0xA5
+//   1     channel
+//   2-3   raw value
+//   4-5   responsive value
+//   6     flags (RESPONSIVE_TELEMETRY_CHANGED, RESPONSIVE_TELEMETRY_SLEEPING)
+//   7-10  timestamp in milliseconds
+//   11    CRC-8 (poly 0x07) over bytes 1-10
+// extras/host/rar_telemetry_decode.cpp turns a captured stream back into text
+#define RESPONSIVE_TELEMETRY_SYNC 0xA5
+#define RESPONSIVE_TELEMETRY_FRAME_SIZE 12
+#define RESPONSIVE_TELEMETRY_CHANGED 0x01
+#define RESPONSIVE_TELEMETRY_SLEEPING 0x02
+
+uint8_t responsiveCrc8(const uint8_t* data, uint8_t length);
+
+class ResponsiveTelemetry
+{
+  public:
+
+    // queue one frame, returns false (and counts a drop) if the buffer has no room for it
+    bool push(uint8_t channel, int raw, int value, uint8_t flags);
+
+    // send as much of the buffer as the port accepts without blocking, call once per loop.
+    // Relies on port.availableForWrite(); a port that has never reported room (one that doesn't implement it)
+    // gets one frame per call instead, and write() may block for that frame
+    void flush(Print& port);
+
+    inline uint16_t getDropped() { return dropped; } // frames lost because the buffer was full
+    inline uint16_t getPending() { return (uint16_t)(head - tail); } // bytes waiting to be sent
+    inline void resetDropped() { dropped = 0; }
+
+  private:
+    uint8_t buffer[RESPONSIVE_TELEMETRY_BUFFER];
+    uint16_t head = 0;
+    uint16_t tail = 0;
+    uint16_t dropped = 0;
+    bool portReportsRoom = false;
+};
+
+#endif